@@ -0,0 +1,499 @@
+// resman-lite-bench: what embedding costs at run time.
+//
+// For every scenario (<count>x<size>: count resources of size bytes each) it
+// writes the resource files, builds them with ResBuildOrchestrator like a
+// regular build, links them into resman_bench_probe.cpp and runs the probe.
+// A probe without resources is the baseline the startup figures are compared
+// with. Every measurement runs --repetitions times in fresh processes; the
+// report holds the median of each figure.
+
+#include <iostream>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <functional>
+#include <argparse/argparse.hpp>
+#include <nlohmann/json.hpp>
+#include "ResBuildOrchestrator.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+#ifndef RESMAN_BENCH_PROBE_SOURCE
+#error "RESMAN_BENCH_PROBE_SOURCE must name bench/resman_bench_probe.cpp (set by CMakeLists.txt)"
+#endif
+#ifndef RESMAN_BENCH_INCLUDE_DIR
+#error "RESMAN_BENCH_INCLUDE_DIR must name the runtime include dir (set by CMakeLists.txt)"
+#endif
+
+namespace
+{
+#if defined(_WIN32)
+    const char* const kProbeName = "probe.exe";
+#else
+    const char* const kProbeName = "probe";
+#endif
+
+    struct Scenario
+    {
+        std::string name;
+        unsigned count = 0;
+        std::uint64_t bytes = 0;
+    };
+
+    struct BenchConfig
+    {
+        fs::path workDir;
+        unsigned repetitions = 5;
+        unsigned jobs = 0;
+        bool blobLayout = false;
+        bool dropPageCache = true;
+        std::string clangPath;
+        std::string llvmAsPath;
+        std::string llvmLinkPath;
+        std::string llcPath;
+    };
+
+    std::string quote(const std::string& path)
+    {
+        if (path.find(' ') != std::string::npos)
+            return "\"" + path + "\"";
+        return path;
+    }
+
+    // "4096", "16K", "64M", "1G"
+    std::uint64_t parseSize(const std::string& text)
+    {
+        size_t end = 0;
+        std::uint64_t value = std::stoull(text, &end);
+        std::string suffix = text.substr(end);
+        if (suffix == "K" || suffix == "k")
+            return value << 10;
+        if (suffix == "M" || suffix == "m")
+            return value << 20;
+        if (suffix == "G" || suffix == "g")
+            return value << 30;
+        if (!suffix.empty())
+            throw std::runtime_error("invalid size: " + text);
+        return value;
+    }
+
+    // "1000x16K"
+    Scenario parseScenario(const std::string& text)
+    {
+        auto x = text.find('x');
+        if (x == std::string::npos)
+            throw std::runtime_error("--scenario expects <count>x<size>, got: " + text);
+
+        Scenario scenario;
+        scenario.name = text;
+        scenario.count = static_cast<unsigned>(std::stoul(text.substr(0, x)));
+        scenario.bytes = parseSize(text.substr(x + 1));
+        if (scenario.count == 0)
+            throw std::runtime_error("--scenario needs at least one resource: " + text);
+        return scenario;
+    }
+
+    // Distinct pseudo-random contents per file, so nothing compresses or folds
+    bool writeResourceFiles(const fs::path& dir, const Scenario& scenario)
+    {
+        fs::create_directories(dir);
+        std::vector<std::uint64_t> block(1 << 16);
+
+        for (unsigned i = 1; i <= scenario.count; ++i)
+        {
+            std::ofstream out(dir / ("r" + std::to_string(i) + ".bin"), std::ios::binary | std::ios::trunc);
+            std::mt19937_64 rng(i);
+            std::uint64_t left = scenario.bytes;
+            while (left)
+            {
+                for (auto& word : block)
+                    word = rng();
+                size_t count = static_cast<size_t>(std::min<std::uint64_t>(left, block.size() * sizeof(block[0])));
+                out.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(count));
+                left -= count;
+            }
+            if (!out)
+                return false;
+        }
+        return true;
+    }
+
+    bool buildResources(const BenchConfig& config, const Scenario& scenario, const fs::path& dir, const fs::path& obj)
+    {
+        std::vector<resman::ResourceInfo> resources;
+        resources.reserve(scenario.count);
+        for (unsigned i = 1; i <= scenario.count; ++i)
+        {
+            std::string id = std::to_string(i);
+            resources.push_back({ "r" + id, "resman::Resource<" + id + ">", "r" + id + ".bin" });
+        }
+
+        resman::BuildOptions opts;
+        opts.outputObj = obj.string();
+        opts.includePaths = { RESMAN_BENCH_INCLUDE_DIR };
+        opts.resPaths = { (dir / "res").string() };
+        opts.emitRegistry = true;
+        opts.blobLayout = config.blobLayout;
+        opts.useCache = false;
+        opts.jobs = config.jobs;
+        opts.clangPath = config.clangPath;
+        opts.llvmAsPath = config.llvmAsPath;
+        opts.llvmLinkPath = config.llvmLinkPath;
+        opts.llcPath = config.llcPath;
+
+        // only problems; the pipeline's progress would drown the results
+        resman::ResBuildOrchestrator build;
+        return build.setOptions(opts)
+            .setResourceInfo(resources)
+            .setLogCallback([](resman::LogLevel level, const std::string& component, const std::string& message) {
+                if (level != resman::LogLevel::Info)
+                    resman::defaultLogCallback(level, component, message);
+            })
+            .run();
+    }
+
+    bool buildProbe(const BenchConfig& config, unsigned count, const fs::path& obj, const fs::path& probe)
+    {
+        std::ostringstream cmd;
+        cmd << quote(config.clangPath) << " -std=c++17 -O2"
+            << " -I" << quote(RESMAN_BENCH_INCLUDE_DIR)
+            << " -DRESMAN_BENCH_COUNT=" << count;
+        if (config.blobLayout)
+            cmd << " -DRESMAN_BLOB_LAYOUT";
+        cmd << " " << quote(RESMAN_BENCH_PROBE_SOURCE);
+        if (!obj.empty())
+            cmd << " " << quote(obj.string());
+        cmd << " -o " << quote(probe.string());
+#if defined(_WIN32)
+        cmd << " -lpsapi";
+#endif
+        return std::system(cmd.str().c_str()) == 0;
+    }
+
+    // Evicts the probe from the page cache, so its data is read from disk on first touch
+    bool dropFromPageCache(const fs::path& path)
+    {
+#if defined(__linux__)
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        ::fdatasync(fd);   // only clean pages can be dropped
+        bool dropped = ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+        ::close(fd);
+        return dropped;
+#else
+        (void)path;
+        return false;
+#endif
+    }
+
+    // Runs the probe once; its JSON output and the wall time of the whole run
+    bool runProbe(const fs::path& probe, const std::string& mode, bool cold, json& result, double& wallMs)
+    {
+        if (cold)
+            dropFromPageCache(probe);
+
+        fs::path outFile = probe.parent_path() / ("probe-" + mode + ".json");
+        std::string cmd = quote(probe.string()) + " " + mode + " > " + quote(outFile.string());
+
+        auto start = std::chrono::steady_clock::now();
+        int rc = std::system(cmd.c_str());
+        wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (rc != 0)
+        {
+            std::cerr << "Error: probe failed (" << rc << "): " << cmd << "\n";
+            return false;
+        }
+
+        std::ifstream in(outFile);
+        result = json::parse(in, nullptr, false);
+        if (result.is_discarded())
+        {
+            std::cerr << "Error: unreadable probe output: " << outFile.string() << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    double median(std::vector<double> values)
+    {
+        if (values.empty())
+            return 0.0;
+        std::sort(values.begin(), values.end());
+        size_t mid = values.size() / 2;
+        return values.size() % 2 ? values[mid] : (values[mid - 1] + values[mid]) / 2;
+    }
+
+    // Element-wise median of the numbers in runs of the same JSON shape
+    json medianOf(const std::vector<json>& runs)
+    {
+        const json& first = runs.front();
+        if (first.is_object())
+        {
+            json merged = json::object();
+            for (auto it = first.begin(); it != first.end(); ++it)
+            {
+                std::vector<json> values;
+                for (const auto& run : runs)
+                    values.push_back(run.at(it.key()));
+                merged[it.key()] = medianOf(values);
+            }
+            return merged;
+        }
+        if (!first.is_number())
+            return first;
+
+        std::vector<double> values;
+        for (const auto& run : runs)
+            values.push_back(run.get<double>());
+        return first.is_number_float() ? json(median(values)) : json(static_cast<long long>(median(values)));
+    }
+
+    json percentiles(std::vector<double> values)
+    {
+        std::sort(values.begin(), values.end());
+        auto at = [&values](double p) {
+            return values[std::min(values.size() - 1, static_cast<size_t>(p * static_cast<double>(values.size())))];
+        };
+        return { { "p50", at(0.50) }, { "p90", at(0.90) }, { "p99", at(0.99) }, { "max", values.back() } };
+    }
+
+    // Runs one probe mode --repetitions times; the median result, and the wall times
+    bool measure(const BenchConfig& config, const fs::path& probe, const std::string& mode, json& result, std::vector<double>& wallMs)
+    {
+        std::vector<json> runs;
+        for (unsigned rep = 0; rep < config.repetitions; ++rep)
+        {
+            json run;
+            double ms = 0;
+            if (!runProbe(probe, mode, config.dropPageCache, run, ms))
+                return false;
+            runs.push_back(std::move(run));
+            wallMs.push_back(ms);
+        }
+        result = medianOf(runs);
+        return true;
+    }
+
+    bool measureStartup(const BenchConfig& config, const fs::path& probe, json& result)
+    {
+        std::vector<double> wallMs;
+        if (!measure(config, probe, "startup", result, wallMs))
+            return false;
+        result["wallMs"] = percentiles(wallMs);
+        return true;
+    }
+
+    bool runScenario(const BenchConfig& config, const Scenario& scenario, const json& baseline, json& result)
+    {
+        fs::path dir = config.workDir / scenario.name;
+        fs::path obj = dir / "resources.o";
+        fs::path probe = dir / kProbeName;
+
+        std::cout << "Scenario " << scenario.name << ": writing " << scenario.count << " resource file(s)\n";
+        if (!writeResourceFiles(dir / "res", scenario))
+        {
+            std::cerr << "Error: failed to write resources under " << (dir / "res").string() << "\n";
+            return false;
+        }
+
+        std::cout << "Scenario " << scenario.name << ": building\n";
+        auto start = std::chrono::steady_clock::now();
+        if (!buildResources(config, scenario, dir, obj))
+        {
+            std::cerr << "Error: resman-lite build failed for " << scenario.name << "\n";
+            return false;
+        }
+        double buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (!buildProbe(config, scenario.count, obj, probe))
+        {
+            std::cerr << "Error: failed to link the probe for " << scenario.name << "\n";
+            return false;
+        }
+
+        // the resources are in the probe now
+        std::error_code ec;
+        fs::remove_all(dir / "res", ec);
+
+        std::cout << "Scenario " << scenario.name << ": measuring\n";
+        json startup, access, scan;
+        std::vector<double> unusedWallMs;
+        if (!measureStartup(config, probe, startup) ||
+            !measure(config, probe, "access", access, unusedWallMs) ||
+            !measure(config, probe, "scan", scan, unusedWallMs))
+            return false;
+
+        startup["addedMs"] = startup["wallMs"]["p50"].get<double>() - baseline["wallMs"]["p50"].get<double>();
+        startup["addedMinorFaults"] = startup["minorFaults"].get<long long>() - baseline["minorFaults"].get<long long>();
+        startup["addedMaxRssKiB"] = startup["maxRssKiB"].get<long long>() - baseline["maxRssKiB"].get<long long>();
+
+        result = {
+            { "name", scenario.name },
+            { "resources", scenario.count },
+            { "resourceBytes", scenario.bytes },
+            { "totalBytes", std::uint64_t(scenario.count) * scenario.bytes },
+            { "buildSeconds", buildSeconds },
+            { "binaryBytes", fs::file_size(probe) },
+            { "startup", startup },
+            { "access", access },
+            { "scan", scan }
+        };
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    argparse::ArgumentParser program("resman-lite-bench", "0.1");
+
+    program.add_description("Measures the run time cost of embedded resources (startup, page faults, "
+                            "access latency, throughput) and writes it as JSON.");
+
+    program.add_argument("-o", "--output")
+        .help("JSON report to write")
+        .default_value(std::string("resman-bench.json"));
+
+    program.add_argument("--scenario")
+        .help("<count>x<size>, e.g. 1000x16K (repeatable; default 1x4K, 1x64M, 1000x16K, 50000x1K)")
+        .append();
+
+    program.add_argument("--large")
+        .help("Add the 1 GiB scenarios 1x1G and 1000x1M")
+        .default_value(false)
+        .implicit_value(true);
+
+    program.add_argument("--repetitions")
+        .help("Runs of every measurement; the report holds the medians")
+        .default_value(5u)
+        .scan<'u', unsigned>();
+
+    program.add_argument("--work-dir")
+        .help("Where resources, objects and probes are written (default: <temp>/resman-lite-bench)")
+        .default_value(std::string(""));
+
+    program.add_argument("--blob-layout")
+        .help("Build and read the resources with the blob layout")
+        .default_value(false)
+        .implicit_value(true);
+
+    program.add_argument("--no-drop-cache")
+        .help("Keep the probe in the page cache between runs (Linux drops it by default)")
+        .default_value(false)
+        .implicit_value(true);
+
+    program.add_argument("-j", "--jobs")
+        .help("Threads used by the resman-lite builds (0: one per core)")
+        .default_value(0u)
+        .scan<'u', unsigned>();
+
+    program.add_argument("--clang-path")
+        .help("clang++ used for the builds and to link the probes")
+        .default_value(std::string("clang++"));
+
+    program.add_argument("--llvm-as-path")
+        .default_value(std::string("llvm-as"));
+
+    program.add_argument("--llvm-link-path")
+        .default_value(std::string("llvm-link"));
+
+    program.add_argument("--llc-path")
+        .default_value(std::string("llc"));
+
+    BenchConfig config;
+    std::vector<Scenario> scenarios;
+    std::string output;
+
+    try
+    {
+        program.parse_args(argc, argv);
+
+        output = program.get<std::string>("--output");
+        config.repetitions = std::max(1u, program.get<unsigned>("--repetitions"));
+        config.jobs = program.get<unsigned>("--jobs");
+        config.blobLayout = program.get<bool>("--blob-layout");
+        config.dropPageCache = !program.get<bool>("--no-drop-cache");
+        config.clangPath = program.get<std::string>("--clang-path");
+        config.llvmAsPath = program.get<std::string>("--llvm-as-path");
+        config.llvmLinkPath = program.get<std::string>("--llvm-link-path");
+        config.llcPath = program.get<std::string>("--llc-path");
+
+        std::string workDir = program.get<std::string>("--work-dir");
+        config.workDir = workDir.empty() ? fs::temp_directory_path() / "resman-lite-bench" : fs::path(workDir);
+
+        std::vector<std::string> specs = { "1x4K", "1x64M", "1000x16K", "50000x1K" };
+        if (program.is_used("--scenario"))
+            specs = program.get<std::vector<std::string>>("--scenario");
+        if (program.get<bool>("--large"))
+        {
+            specs.push_back("1x1G");
+            specs.push_back("1000x1M");
+        }
+        for (const auto& spec : specs)
+            scenarios.push_back(parseScenario(spec));
+    }
+    catch (const std::exception& err)
+    {
+        std::cerr << "Error: " << err.what() << "\n\n";
+        std::cerr << program;
+        return 1;
+    }
+
+    try
+    {
+        fs::create_directories(config.workDir / "baseline");
+        fs::path baselineProbe = config.workDir / "baseline" / kProbeName;
+        json baseline;
+
+        std::cout << "Baseline: linking a probe without resources\n";
+        if (!buildProbe(config, 0, fs::path(), baselineProbe) || !measureStartup(config, baselineProbe, baseline))
+        {
+            std::cerr << "Benchmark failed.\n";
+            return 1;
+        }
+
+        json report = {
+            { "version", 1 },
+            { "layout", config.blobLayout ? "blob" : "default" },
+            { "repetitions", config.repetitions },
+            { "pageCacheDropped", config.dropPageCache && dropFromPageCache(baselineProbe) },
+            { "baseline", { { "binaryBytes", fs::file_size(baselineProbe) }, { "startup", baseline } } },
+            { "scenarios", json::array() }
+        };
+
+        for (const auto& scenario : scenarios)
+        {
+            json result;
+            if (!runScenario(config, scenario, baseline, result))
+            {
+                std::cerr << "Benchmark failed.\n";
+                return 1;
+            }
+            report["scenarios"].push_back(std::move(result));
+        }
+
+        std::ofstream out(output, std::ios::trunc);
+        out << report.dump(4) << "\n";
+        if (!out)
+        {
+            std::cerr << "Error: failed to write " << output << "\n";
+            return 1;
+        }
+        std::cout << "Benchmark results written to " << output << "\n";
+        return 0;
+    }
+    catch (const std::exception& err)
+    {
+        std::cerr << "Error: " << err.what() << "\n";
+        return 1;
+    }
+}
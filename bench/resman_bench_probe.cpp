@@ -0,0 +1,219 @@
+// Runtime side of resman-lite-bench. Linked with an object of
+// RESMAN_BENCH_COUNT resources (ids 1..N, built with --resource-registry),
+// it measures one thing per process and prints it as one JSON object:
+//
+//   probe startup   counters at the top of main()
+//   probe access    handle construction, iteration, first-touch and warm access latency
+//   probe scan      cold and warm read throughput over every embedded byte
+//
+// Each mode runs in a fresh process, so "cold" means the first touch of the
+// data in that process; the driver also evicts the binary from the page cache.
+
+#include "resman.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#ifndef RESMAN_BENCH_COUNT
+#define RESMAN_BENCH_COUNT 0
+#endif
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	// Resources touched by the latency measurements (all of them up to this many)
+	constexpr std::size_t kMaxSamples = 10000;
+
+	struct Counters {
+		long long minorFaults;
+		long long majorFaults;
+		long long maxRssKiB;
+	};
+
+	Counters counters() {
+#if defined(_WIN32)
+		PROCESS_MEMORY_COUNTERS pmc = {};
+		GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
+		return { static_cast<long long>(pmc.PageFaultCount), 0, static_cast<long long>(pmc.PeakWorkingSetSize / 1024) };
+#else
+		rusage usage = {};
+		getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+		const long long rssKiB = usage.ru_maxrss / 1024;	// bytes on macOS
+#else
+		const long long rssKiB = usage.ru_maxrss;
+#endif
+		return { usage.ru_minflt, usage.ru_majflt, rssKiB };
+#endif
+	}
+
+	double elapsedNs(Clock::time_point start, Clock::time_point end) {
+		return std::chrono::duration<double, std::nano>(end - start).count();
+	}
+
+	void printPercentiles(const char* name, std::vector<double>& samples) {
+		std::sort(samples.begin(), samples.end());
+		auto at = [&samples](double p) {
+			if (samples.empty())
+				return 0.0;
+			const std::size_t index = static_cast<std::size_t>(p * static_cast<double>(samples.size()));
+			return samples[std::min(index, samples.size() - 1)];
+		};
+		std::printf("\"%s\":{\"p50\":%.1f,\"p90\":%.1f,\"p99\":%.1f,\"max\":%.1f}", name, at(0.50), at(0.90), at(0.99),
+			samples.empty() ? 0.0 : samples.back());
+	}
+
+	template <unsigned... I>
+	std::vector<resman::ResourceHandle> makeHandles(std::integer_sequence<unsigned, I...>) {
+		return { resman::ResourceHandle(resman::Resource<I + 1>(""))... };
+	}
+
+	std::vector<resman::ResourceHandle> makeHandles() {
+		return makeHandles(std::make_integer_sequence<unsigned, RESMAN_BENCH_COUNT>());
+	}
+
+	// Keeps the reads from being optimized away
+	volatile std::uint64_t g_sink;
+
+	std::uint64_t touchFirstByte(resman::ResourceHandle res) {
+		const std::size_t size = res.size();
+		return size ? static_cast<unsigned char>(*res.data()) + size : 0;
+	}
+
+	std::uint64_t readAll(const std::vector<resman::ResourceHandle>& handles) {
+		std::uint64_t sum = 0;
+		for (resman::ResourceHandle res : handles) {
+			res.forEachSegment([&sum](const char* data, std::size_t size) {
+				std::size_t i = 0;
+				for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t)) {
+					std::uint64_t word;
+					std::memcpy(&word, data + i, sizeof(word));
+					sum += word;
+				}
+				for (; i < size; ++i)
+					sum += static_cast<unsigned char>(data[i]);
+			});
+		}
+		return sum;
+	}
+
+	int runStartup(const Counters& atStart) {
+		std::printf("{\"minorFaults\":%lld,\"majorFaults\":%lld,\"maxRssKiB\":%lld}\n",
+			atStart.minorFaults, atStart.majorFaults, atStart.maxRssKiB);
+		return 0;
+	}
+
+	int runAccess() {
+		// timed the second time, without the allocator's first-use cost
+		std::vector<resman::ResourceHandle> handles = makeHandles();
+		handles.clear();
+		handles.shrink_to_fit();
+
+		Clock::time_point start = Clock::now();
+		handles = makeHandles();
+		const double constructNs = elapsedNs(start, Clock::now());
+
+		std::size_t registered = 0;
+		std::uint64_t registeredBytes = 0;
+		start = Clock::now();
+		resman::forEachResource([&](const resman::detail::RegistryEntry& entry) {
+			++registered;
+			registeredBytes += entry.size;
+		});
+		const double iterateNs = elapsedNs(start, Clock::now());
+		g_sink = registeredBytes;
+
+		// the same random sample for the cold and the warm pass
+		std::vector<resman::ResourceHandle> sample = handles;
+		std::shuffle(sample.begin(), sample.end(), std::mt19937(42));
+		if (sample.size() > kMaxSamples)
+			sample.erase(sample.begin() + kMaxSamples, sample.end());
+
+		std::vector<double> firstTouch, warm;
+		firstTouch.reserve(sample.size());
+		warm.reserve(sample.size());
+
+		const Counters before = counters();
+		for (resman::ResourceHandle res : sample) {
+			start = Clock::now();
+			g_sink = touchFirstByte(res);
+			firstTouch.push_back(elapsedNs(start, Clock::now()));
+		}
+		const Counters after = counters();
+
+		std::shuffle(sample.begin(), sample.end(), std::mt19937(7));
+		for (resman::ResourceHandle res : sample) {
+			start = Clock::now();
+			g_sink = touchFirstByte(res);
+			warm.push_back(elapsedNs(start, Clock::now()));
+		}
+
+		const double perHandle = handles.empty() ? 0.0 : constructNs / static_cast<double>(handles.size());
+		const double perEntry = registered ? iterateNs / static_cast<double>(registered) : 0.0;
+		std::printf("{\"resources\":%zu,\"registered\":%zu,\"samples\":%zu,\"constructNsPerHandle\":%.2f,\"iterateNsPerResource\":%.2f,",
+			handles.size(), registered, sample.size(), perHandle, perEntry);
+		printPercentiles("firstTouchNs", firstTouch);
+		std::printf(",\"firstTouchMinorFaults\":%lld,\"firstTouchMajorFaults\":%lld,",
+			after.minorFaults - before.minorFaults, after.majorFaults - before.majorFaults);
+		printPercentiles("warmAccessNs", warm);
+		std::printf("}\n");
+		return 0;
+	}
+
+	int runScan() {
+		const std::vector<resman::ResourceHandle> handles = makeHandles();
+		std::uint64_t bytes = 0;
+		for (resman::ResourceHandle res : handles)
+			bytes += res.size();
+
+		const Counters before = counters();
+		Clock::time_point start = Clock::now();
+		g_sink = readAll(handles);
+		const double coldNs = elapsedNs(start, Clock::now());
+		const Counters after = counters();
+
+		start = Clock::now();
+		g_sink = readAll(handles);
+		const double warmNs = elapsedNs(start, Clock::now());
+
+		auto mibPerSecond = [bytes](double ns) {
+			return ns > 0 ? static_cast<double>(bytes) / (1024.0 * 1024.0) / (ns / 1e9) : 0.0;
+		};
+		std::printf("{\"bytes\":%llu,\"coldMiBps\":%.1f,\"warmMiBps\":%.1f,\"minorFaults\":%lld,\"majorFaults\":%lld,\"rssAddedKiB\":%lld}\n",
+			static_cast<unsigned long long>(bytes), mibPerSecond(coldNs), mibPerSecond(warmNs),
+			after.minorFaults - before.minorFaults, after.majorFaults - before.majorFaults,
+			after.maxRssKiB - before.maxRssKiB);
+		return 0;
+	}
+}
+
+int main(int argc, char** argv) {
+	const Counters atStart = counters();
+	const char* mode = argc > 1 ? argv[1] : "";
+
+	if (std::strcmp(mode, "startup") == 0)
+		return runStartup(atStart);
+	if (std::strcmp(mode, "access") == 0)
+		return runAccess();
+	if (std::strcmp(mode, "scan") == 0)
+		return runScan();
+
+	std::fprintf(stderr, "usage: %s startup|access|scan\n", argv[0]);
+	return 2;
+}
@@ -0,0 +1,222 @@
+# ResmanLite.cmake
+#
+# resman_add_resources(<target>
+#     HEADER <resource-header>...
+#     [RESOURCE_DIRS <dir>...]
+#     [INCLUDE_DIRS <dir>...]
+#     [MODE OBJECT|STATIC]
+#     [SHARDS <count>]
+#     [TARGET_TRIPLE <triple>]
+#     [CACHE_DIR <dir>]
+#     [REGISTRY]
+#     [DEV_MODE]
+#     [DEDUP_CONTENT]
+#     [BLOB_LAYOUT]
+#     [CHUNK_DEDUP]
+#     [SIZE_REPORT]
+#     [SIZE_BUDGET <budget.json>])
+#
+# Embeds every resman::Resource<> declared in the HEADER(s) into <target>.
+# Several headers are parsed concurrently and cached independently; the same
+# Resource<N> bound to different files in two headers is an error.
+#
+# The resources are split into SHARDS independent resman-lite invocations
+# (default 4), each one a custom command the generator can run in parallel.
+# Each command writes a depfile, so it reruns only when the header, one of
+# its includes or one of the embedded files changes. Objects are written only
+# when their contents change, so unchanged shards don't trigger relinks.
+#
+# MODE OBJECT (default) adds the objects to <target>'s sources; MODE STATIC
+# archives them into <target>_resources and links that into <target>.
+#
+# REGISTRY registers the resources with the runtime (resman::forEachResource,
+# resman::prefetchAll from resman_prefetch.h).
+#
+# DEV_MODE only records each resource's path; <target> is compiled with
+# RESMAN_DEV_MODE and reads the files at run time, reloading them when they
+# change, so editing an asset needs neither resman-lite nor a relink. A
+# common setup is DEV_MODE for Debug builds only, via a project option.
+#
+# DEDUP_CONTENT keys each resource's bytes by content hash in a COMDAT, so
+# data embedded by several libraries is linked once. Every target of the
+# program that includes resman.h must then be compiled with
+# RESMAN_DEDUP_CONTENT; it is added to <target> publicly.
+#
+# BLOB_LAYOUT puts each shard's resources in one blob with an index of
+# relative offsets, so link time and startup relocations don't grow with the
+# number of resources. Needs RESMAN_BLOB_LAYOUT, added publicly as well.
+# Each shard defines a single symbol, resman_lite_blob_<target>_<header>_<shard>;
+# when they end up in an archive (MODE STATIC, or <target> a static library),
+# they are force-linked, as nothing names them.
+# CHUNK_DEDUP (implies BLOB_LAYOUT) stores content-defined chunks shared by
+# near-identical files once per shard; put such families in one shard
+# (e.g. SHARDS 1) for the best ratio.
+#
+# SIZE_REPORT writes each shard's size report next to its object
+# (<obj>.size.json and <obj>.size.txt). SIZE_BUDGET fails the shard whose
+# resources exceed a limit of the budget file; its "total" applies per shard.
+
+include_guard(GLOBAL)
+
+if(CMAKE_VERSION VERSION_LESS 3.20)
+    message(FATAL_ERROR "ResmanLite.cmake needs CMake 3.20 or newer (DEPFILE support for all generators)")
+endif()
+
+# resman-lite executable: the in-tree / imported target, or one found on PATH
+if(NOT DEFINED RESMAN_LITE_EXECUTABLE)
+    if(TARGET resman-lite::resman-lite)
+        set(RESMAN_LITE_EXECUTABLE resman-lite::resman-lite)
+    else()
+        find_program(RESMAN_LITE_EXECUTABLE resman-lite REQUIRED)
+    endif()
+endif()
+
+function(resman_add_resources target)
+    cmake_parse_arguments(PARSE_ARGV 1 RESMAN
+        "REGISTRY;DEV_MODE;DEDUP_CONTENT;BLOB_LAYOUT;CHUNK_DEDUP;SIZE_REPORT"
+        "MODE;SHARDS;TARGET_TRIPLE;CACHE_DIR;SIZE_BUDGET"
+        "HEADER;RESOURCE_DIRS;INCLUDE_DIRS")
+
+    if(NOT TARGET ${target})
+        message(FATAL_ERROR "resman_add_resources: ${target} is not a target")
+    endif()
+    if(NOT RESMAN_HEADER)
+        message(FATAL_ERROR "resman_add_resources: HEADER is required")
+    endif()
+    if(RESMAN_UNPARSED_ARGUMENTS)
+        message(FATAL_ERROR "resman_add_resources: unknown arguments: ${RESMAN_UNPARSED_ARGUMENTS}")
+    endif()
+
+    if(NOT RESMAN_MODE)
+        set(RESMAN_MODE OBJECT)
+    endif()
+    if(NOT RESMAN_MODE MATCHES "^(OBJECT|STATIC)$")
+        message(FATAL_ERROR "resman_add_resources: MODE must be OBJECT or STATIC, got ${RESMAN_MODE}")
+    endif()
+
+    if(NOT RESMAN_SHARDS)
+        set(RESMAN_SHARDS 4)
+    endif()
+
+    set(headers)
+    set(header_args)
+    foreach(header IN LISTS RESMAN_HEADER)
+        get_filename_component(header "${header}" ABSOLUTE)
+        list(APPEND headers "${header}")
+        list(APPEND header_args --res-header "${header}")
+    endforeach()
+    list(GET RESMAN_HEADER 0 first_header)
+    get_filename_component(header_name "${first_header}" NAME_WE)
+    set(out_dir "${CMAKE_CURRENT_BINARY_DIR}/resman/${target}/${header_name}")
+    file(MAKE_DIRECTORY "${out_dir}")
+
+    # generated sources include resman.h, and so does the target's own code
+    target_link_libraries(${target} PRIVATE resman-lite::runtime)
+
+    set(common_args ${header_args} --write-if-changed
+        "-I$<JOIN:$<TARGET_PROPERTY:resman-lite::runtime,INTERFACE_INCLUDE_DIRECTORIES>,$<SEMICOLON>-I>")
+    foreach(dir IN LISTS RESMAN_INCLUDE_DIRS)
+        get_filename_component(dir "${dir}" ABSOLUTE)
+        list(APPEND common_args -I "${dir}")
+    endforeach()
+    foreach(dir IN LISTS RESMAN_RESOURCE_DIRS)
+        get_filename_component(dir "${dir}" ABSOLUTE)
+        list(APPEND common_args -R "${dir}")
+    endforeach()
+    if(RESMAN_TARGET_TRIPLE)
+        list(APPEND common_args --mtriple "${RESMAN_TARGET_TRIPLE}")
+    endif()
+    if(RESMAN_CACHE_DIR)
+        list(APPEND common_args --cache-dir "${RESMAN_CACHE_DIR}")
+    endif()
+    if(RESMAN_REGISTRY)
+        list(APPEND common_args --resource-registry)
+    endif()
+    if(RESMAN_DEV_MODE)
+        list(APPEND common_args --dev-mode)
+        target_compile_definitions(${target} PRIVATE RESMAN_DEV_MODE)
+    endif()
+    if(RESMAN_DEDUP_CONTENT)
+        list(APPEND common_args --dedup-content)
+        target_compile_definitions(${target} PUBLIC RESMAN_DEDUP_CONTENT)
+    endif()
+    set(blob_layout OFF)
+    if(RESMAN_BLOB_LAYOUT OR RESMAN_CHUNK_DEDUP)
+        set(blob_layout ON)
+        list(APPEND common_args --blob-layout)
+        target_compile_definitions(${target} PUBLIC RESMAN_BLOB_LAYOUT)
+    endif()
+    if(RESMAN_CHUNK_DEDUP)
+        list(APPEND common_args --chunk-dedup)
+    endif()
+    if(RESMAN_SIZE_BUDGET)
+        get_filename_component(budget "${RESMAN_SIZE_BUDGET}" ABSOLUTE)
+        list(APPEND common_args --size-budget "${budget}")
+    endif()
+
+    # C symbols carry a leading underscore on Apple and 32-bit Windows
+    set(symbol_prefix "")
+    if(APPLE OR (WIN32 AND CMAKE_SIZEOF_VOID_P EQUAL 4))
+        set(symbol_prefix "_")
+    endif()
+
+    set(objects)
+    set(blob_symbols)
+    math(EXPR last_shard "${RESMAN_SHARDS} - 1")
+    foreach(shard RANGE 0 ${last_shard})
+        set(obj "${out_dir}/${header_name}.${shard}${CMAKE_CXX_OUTPUT_EXTENSION}")
+        set(shard_args)
+        if(RESMAN_SIZE_REPORT)
+            set(shard_args --size-report "${obj}.size.json")
+        endif()
+        if(blob_layout)
+            string(MAKE_C_IDENTIFIER "resman_lite_blob_${target}_${header_name}_${shard}" blob_symbol)
+            list(APPEND shard_args --blob-symbol "${blob_symbol}")
+            list(APPEND blob_symbols "${symbol_prefix}${blob_symbol}")
+        endif()
+        add_custom_command(
+            OUTPUT "${obj}"
+            COMMAND ${RESMAN_LITE_EXECUTABLE} ${common_args} ${shard_args}
+                    --obj-name "${obj}"
+                    --shard "${shard}/${RESMAN_SHARDS}"
+                    --working-dir "${out_dir}/work.${shard}"
+                    --depfile "${obj}.d"
+            DEPENDS ${headers} ${RESMAN_LITE_EXECUTABLE}
+            DEPFILE "${obj}.d"
+            COMMENT "resman-lite: embedding ${header_name} (shard ${shard}/${RESMAN_SHARDS})"
+            COMMAND_EXPAND_LISTS
+            VERBATIM)
+        list(APPEND objects "${obj}")
+    endforeach()
+    set_source_files_properties(${objects} PROPERTIES EXTERNAL_OBJECT TRUE GENERATED TRUE)
+
+    if(RESMAN_MODE STREQUAL "STATIC")
+        set(lib ${target}_resources)
+        if(NOT TARGET ${lib})
+            add_library(${lib} STATIC)
+            set_target_properties(${lib} PROPERTIES LINKER_LANGUAGE CXX)
+            target_link_libraries(${target} PRIVATE ${lib})
+        endif()
+        target_sources(${lib} PRIVATE ${objects})
+    else()
+        target_sources(${target} PRIVATE ${objects})
+    endif()
+
+    # nothing names a blob shard's symbol, so the linker would leave it in the
+    # archive: have whatever links the archive pull it in
+    get_target_property(target_type ${target} TYPE)
+    if(target_type STREQUAL "STATIC_LIBRARY")
+        set(link_scope INTERFACE)
+    elseif(RESMAN_MODE STREQUAL "STATIC")
+        set(link_scope PRIVATE)
+    else()
+        set(blob_symbols)
+    endif()
+    foreach(symbol IN LISTS blob_symbols)
+        if(MSVC)
+            target_link_options(${target} ${link_scope} "/INCLUDE:${symbol}")
+        else()
+            target_link_options(${target} ${link_scope} "LINKER:-u,${symbol}")
+        endif()
+    endforeach()
+endfunction()
@@ -0,0 +1,4 @@
+# Package config for an installed resman-lite: find_package(ResmanLite)
+
+include("${CMAKE_CURRENT_LIST_DIR}/ResmanLiteTargets.cmake")
+include("${CMAKE_CURRENT_LIST_DIR}/ResmanLite.cmake")
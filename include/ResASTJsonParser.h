@@ -4,6 +4,7 @@
 #include <vector>
 #include <optional>
 #include <nlohmann/json.hpp> // we’ll use this for JSON parsing
+#include "ResLog.h"
 
 namespace resman
 {
@@ -14,11 +15,27 @@ namespace resman
         std::string resFilepath;
     };
 
+    // Same layout as the extracted-info JSON written by ResASTJsonParser
+    inline void to_json(nlohmann::json& j, const ResourceInfo& r)
+    {
+        j = nlohmann::json{ {"type", r.resType}, {"name", r.resName}, {"path", r.resFilepath} };
+    }
+
+    inline void from_json(const nlohmann::json& j, ResourceInfo& r)
+    {
+        r.resType = j.value("type", "");
+        r.resName = j.value("name", "");
+        r.resFilepath = j.value("path", "");
+    }
+
     class ResASTJsonParser
     {
     public:
         ResASTJsonParser& setInputJson(const std::string& path);
+        ResASTJsonParser& setInputJsonText(const std::string& jsonText); // AST JSON already in memory
         ResASTJsonParser& setOutputJson(const std::string& path); // optional (for extracted data)
+        ResASTJsonParser& setLogCallback(LogCallback callback);
+
         bool run();
 
         // getters
@@ -34,7 +51,10 @@ namespace resman
 
     private:
         std::string mInputJson;
+        std::optional<std::string> mInputJsonText;
         std::string mOutputJson;
         std::vector<ResourceInfo> mResources;
+
+        ResLogger mLog{ "ResASTJsonParser" };
     };
 }
\ No newline at end of file
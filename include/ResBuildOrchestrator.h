@@ -3,27 +3,95 @@
 #include <string>
 #include <vector>
 #include <optional>
+#include <map>
+#include <cstdint>
 #include "ResHeaderParser.h"
+#include "ResHeaderCache.h"
 #include "ResASTJsonParser.h"
 #include "ResCppSrcGenerator.h"
 #include "ResObjGenerator.h"
+#include "ResLayoutProfile.h"
+#include "ResSizeReport.h"
+#include "ResLog.h"
 
 namespace resman
 {
     struct BuildOptions
     {
         std::string resHeader;                     // --res-header
+        std::vector<std::string> resHeaders;       // further --res-header, parsed concurrently
         std::string outputObj;                     // --obj-name
         std::vector<std::string> includePaths;     // -I
         std::vector<std::string> resPaths;         // -R
-        std::string targetTriple;                  // --mtriple
+        std::vector<std::string> targetTriples;    // --mtriple (repeatable / comma-separated)
         std::optional<std::string> workingDir;     // optional
 
+        // Cache of header parse results; falls back to $RESMAN_LITE_CACHE_DIR,
+        // then to <temp>/resman-lite-cache
+        std::optional<std::string> cacheDir;       // --cache-dir
+        bool useCache = true;                      // --no-cache
+
+        // Compiled bitcode/objects shared between projects under <cacheDir>/objects,
+        // also enabled by $RESMAN_LITE_OBJECT_CACHE; --no-cache turns it off
+        bool useObjectCache = false;               // --object-cache
+        std::uint64_t objectCacheMaxBytes = 2ull << 30;  // --object-cache-max-size (MiB)
+
+        std::optional<std::string> depFile;        // --depfile (make/ninja syntax)
+        bool writeIfChanged = false;               // --write-if-changed
+
+        // Only embed every shardCount-th resource, starting at shardIndex,
+        // so several invocations can build one header in parallel
+        unsigned shardIndex = 0;                   // --shard <index>/<count>
+        unsigned shardCount = 1;
+
+        bool emitRegistry = false;                 // --resource-registry
+
+        // Reference resources by path instead of embedding them; consumers
+        // must be built with RESMAN_DEV_MODE defined
+        bool devMode = false;                      // --dev-mode
+
+        // Content-hash keyed COMDAT storage, so resources shared by several
+        // libraries link once; consumers need RESMAN_DEDUP_CONTENT
+        bool dedupContent = false;                 // --dedup-content
+
+        // All resources in one blob with a relocation-free offset index;
+        // consumers need RESMAN_BLOB_LAYOUT
+        bool blobLayout = false;                   // --blob-layout
+
+        // Blob layout storing each distinct content-defined chunk once
+        bool chunkDedup = false;                   // --chunk-dedup (implies blobLayout)
+
+        // extern "C" name of the blob index, unique per program; empty:
+        // resman_lite_blob_<outputObj stem>
+        std::string blobSymbol;                    // --blob-symbol
+
+        // Access profiles (-DRESMAN_PROFILE runtime) ordering resources in the object
+        std::vector<std::string> layoutProfiles;   // --layout-profile (repeatable)
+
+        // Bytes per resource and per header, as JSON (text next to it),
+        // compared with an earlier report; an exceeded budget fails the build
+        std::optional<std::string> sizeReport;     // --size-report
+        std::optional<std::string> sizeBaseline;   // --size-baseline
+        std::optional<std::string> sizeBudget;     // --size-budget
+
+        // Build a second time from scratch (own temp dir, no object cache) and
+        // fail unless the outputs are identical byte for byte
+        bool verifyReproducible = false;           // --verify-reproducible
+
+        // Threads reading, encoding and compiling resources (0: one per core)
+        unsigned jobs = 0;                         // --jobs
+
+        // Stop after llvm-link and write bitcode for LTO; with thinLto, an
+        // archive of per-resource ThinLTO modules instead
+        bool emitBitcode = false;                  // --emit-bc
+        bool thinLto = false;                      // --thin-lto
+
         // LLVM tool paths
         std::string clangPath    = "clang++";       // --clang-path
         std::string llvmAsPath   = "llvm-as";       // --llvm-as-path
         std::string llvmLinkPath = "llvm-link";     // --llvm-link-path
         std::string llcPath      = "llc";           // --llc-path
+        std::string llvmArPath   = "llvm-ar";       // --llvm-ar-path
     };
 
     class ResBuildOrchestrator
@@ -33,15 +101,56 @@ namespace resman
         ~ResBuildOrchestrator();
         
         ResBuildOrchestrator& setOptions(const BuildOptions& opts);
+
+        ResBuildOrchestrator& setLogCallback(LogCallback callback);
+
+        // In-memory inputs, for driving builds from a long-lived host process.
+        // Resource info replaces header parsing; header source replaces resHeader.
+        ResBuildOrchestrator& setResourceInfo(const std::vector<ResourceInfo>& resInfo);
+        ResBuildOrchestrator& setHeaderSource(const std::string& source);
+        ResBuildOrchestrator& addResourceData(const std::string& resFilepath, std::string data);
+
+        // May be called repeatedly; the temp working dir is removed after every run
         bool run();
 
     private:
+        bool runStages();
+        bool verifyReproducible();
+        std::vector<std::string> outputPaths() const;
         bool prepareWorkingDir();
+        bool materializeHeaderSource();
         void cleanupWorkingDir();
+        std::string resolveCacheDir() const;
+        bool objectCacheEnabled() const;
+        std::string blobIndexSymbol() const;
+        bool parseResourceHeaders(std::vector<ResourceInfo>& resources);
+        bool parseResourceHeader(const std::string& header, size_t index,
+                                 std::vector<ResourceInfo>& resources, std::vector<std::string>& dependencies) const;
+        bool mergeResources(const std::vector<std::vector<ResourceInfo>>& perHeader,
+                            std::vector<ResourceInfo>& resources);
+        bool writeDepFile(const std::vector<std::string>& targets) const;
+        std::vector<ResourceInfo> selectShard(const std::vector<ResourceInfo>& resources) const;
+        bool orderByProfile(const ResCppSrcGenerator& cppGen, std::vector<std::string>& cppFiles);
+        bool sizeReportEnabled() const;
+        void collectSizes(const std::vector<ResourceInfo>& resources, const ResCppSrcGenerator& cppGen,
+                          ResSizeReport& report) const;
 
     private:
         BuildOptions mOpts;
         std::string mActiveWorkingDir;
         bool mIsTempWorkingDir = false;
+        bool mVerifying = false;     // the rebuild of --verify-reproducible
+
+        std::optional<std::vector<ResourceInfo>> mResInfo;
+        std::optional<std::string> mHeaderSource;
+        std::map<std::string, std::string> mResData;
+        std::vector<std::string> mHeaderPaths;   // resHeader (or where the header source was written), resHeaders
+        std::map<std::string, std::string> mResourceHeaders;   // "resman::Resource<N>" -> declaring header
+
+        // inputs of the build, for --depfile
+        std::vector<std::string> mHeaderDeps;
+        std::vector<std::string> mResourceDeps;
+
+        ResLogger mLog{ "ResBuildOrchestrator" };
     };
 }
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace resman
+{
+    // FastCDC (normalized chunking): cut points depend on the content only,
+    // so an insertion shifts the chunk boundaries around it and no others.
+    // Used by --chunk-dedup and by binary deltas; both rely on every build
+    // cutting the same bytes the same way.
+    constexpr std::size_t kCdcMinBytes = 2 << 10;
+    constexpr std::size_t kCdcAvgBytes = 8 << 10;
+    constexpr std::size_t kCdcMaxBytes = 64 << 10;
+
+    // Length of the chunk starting at data; size must be at least kCdcMaxBytes
+    // unless data runs up to the end of the input
+    std::size_t cdcCutPoint(const unsigned char* data, std::size_t size);
+
+    // Streams an input through a buffer of bufferBytes (at least kCdcMaxBytes)
+    // and calls onChunk(data, size) for each chunk. read(buffer, size) returns
+    // the bytes read, 0 at the end. Returns the total length of the chunks.
+    std::uint64_t splitContentDefined(const std::function<std::size_t(char*, std::size_t)>& read, std::size_t bufferBytes,
+                                      const std::function<void(const char*, std::size_t)>& onChunk);
+}
@@ -3,23 +3,147 @@
 #include <string>
 #include <vector>
 #include <optional>
+#include <map>
+#include <memory>
+#include <cstdint>
 #include "ResASTJsonParser.h" // for ResourceInfo
+#include "ResLog.h"
 
 namespace resman
 {
+    // What one declared resource costs, for size reports
+    struct GeneratedSize
+    {
+        bool generated = false;
+        unsigned id = 0;
+        std::uint64_t rawBytes = 0;         // the resource file
+        std::uint64_t sourceBytes = 0;      // generated .cpp handed to clang (0 with the blob layout)
+        std::uint64_t emittedBytes = 0;     // bytes it adds to the object's data
+    };
+
     class ResCppSrcGenerator
     {
     public:
+        ResCppSrcGenerator();
+        ~ResCppSrcGenerator();
+
         ResCppSrcGenerator& setOutputCppDir(const std::string& path);
         ResCppSrcGenerator& setResourceInfo(const std::vector<ResourceInfo>& resInfo);
         ResCppSrcGenerator& setResSearchPath(const std::string& resSearchPath);
         ResCppSrcGenerator& setResSearchPath(const std::vector<std::string>& resSearchPath);
 
+        // Contents for a declared resource path, used instead of reading it from disk
+        ResCppSrcGenerator& addResourceData(const std::string& resFilepath, std::string data);
+
+        // Also emit a source registering every resource with the runtime
+        // (resman::forEachResource, resman::prefetchAll)
+        ResCppSrcGenerator& setEmitRegistry(bool enable);
+
+        // Embed only each resource's absolute path and size; the RESMAN_DEV_MODE
+        // runtime maps the file at run time and reloads it when it changes
+        ResCppSrcGenerator& setDevMode(bool enable);
+
+        // Store each resource's bytes under a content-hash keyed COMDAT symbol, so
+        // the same data embedded by several objects or libraries is linked once.
+        // Consumers must be built with RESMAN_DEDUP_CONTENT.
+        ResCppSrcGenerator& setDedupContent(bool enable);
+
+        // Lay all resources out in one blob symbol, indexed by a table of offsets
+        // relative to it: no per-resource symbols or relocations. Consumers must
+        // be built with RESMAN_BLOB_LAYOUT.
+        ResCppSrcGenerator& setBlobLayout(bool enable);
+
+        // With the blob layout: split resources into content-defined chunks
+        // (FastCDC) and store every distinct chunk once; near-identical files
+        // share most of their bytes. Split resources are assembled on first access.
+        ResCppSrcGenerator& setChunkDedup(bool enable);
+
+        // With the blob layout: the extern "C" name of the object's index, the only
+        // symbol it defines; unique per program (default resman_lite_blob_index)
+        ResCppSrcGenerator& setBlobIndexSymbol(const std::string& symbol);
+
+        // Resources are read and encoded by this many threads (0: one per core).
+        // Read buffers of all threads together stay under maxBytesInFlight.
+        ResCppSrcGenerator& setThreadCount(unsigned count);
+        ResCppSrcGenerator& setMaxBytesInFlight(std::uint64_t bytes);
+
+        ResCppSrcGenerator& setLogCallback(LogCallback callback);
+
         bool run();
 
+        // Stepwise generation, for callers scheduling the resources themselves
+        // (run() does all three): beginGeneration() once, generateResource() for
+        // every declared resource in any order and from any thread, then
+        // finishGeneration(), which reports in declaration order and writes the registry.
+        bool beginGeneration();
+        void generateResource(size_t index);
+        bool finishGeneration();
+        size_t getResourceCount() const noexcept { return mResInfo.size(); }
+
+        // .cpp written by generateResource(index); empty if the resource was skipped
+        // (or, with the blob layout, is written by finishGeneration())
+        const std::string& getGeneratedSource(size_t index) const { return mResults[index].outputPath; }
+
+        // Resource files found on disk during run(), in generation order
+        const std::vector<std::string>& getResolvedPaths() const noexcept { return mResolvedPaths; }
+
+        // Every path a resource that could not be located was looked for at;
+        // creating one of them changes the build, so they belong in a depfile
+        const std::vector<std::string>& getMissingPaths() const noexcept { return mMissingPaths; }
+
+        // Resource id and generated .cpp of every resource written by run(), in declaration order
+        const std::vector<std::pair<unsigned, std::string>>& getGeneratedSources() const noexcept { return mGeneratedSources; }
+
+        // Sizes of every declared resource, in declaration order, after finishGeneration()
+        std::vector<GeneratedSize> getResourceSizes() const;
+
     private:
+        // Content-defined chunk of a resource (--chunk-dedup)
+        struct ContentChunk
+        {
+            std::uint64_t offset;
+            std::uint32_t size;
+            std::string hash;
+        };
+
+        // Outcome of one resource, kept per slot so the results can be merged in
+        // declaration order whatever order the worker threads finish in
+        struct GeneratedResource
+        {
+            bool generated = false;
+            bool failed = false;             // write error, fails the whole run
+            unsigned id = 0;
+            std::uint64_t size = 0;
+            std::uint64_t sourceBytes = 0;
+            std::uint64_t emittedBytes = 0;  // with --chunk-dedup, set by writeChunkStore()
+            std::string resolvedPath;
+            std::vector<std::string> missingPaths;
+            std::string outputPath;
+            std::string blobFile;            // blob layout: the file to .incbin
+            std::vector<ContentChunk> chunks;
+            std::vector<std::pair<LogLevel, std::string>> messages;
+        };
+
+        class ByteBudget;
+
+        // Index entry of the blob layout
+        struct BlobEntry
+        {
+            unsigned id;
+            std::uint64_t offset;
+            std::uint64_t size;
+        };
+
         bool validateInputs() const;
-        bool generateCppSource() const;
+        bool generateCppSource();
+        void writeResourceSource(const ResourceInfo& res, const std::string& baseName,
+                                 ByteBudget& budget, GeneratedResource& result) const;
+        bool writeDevModeSource(std::ostream& out, unsigned id, const std::string& filePath, std::uint64_t size) const;
+        bool generateBlobSource();
+        bool writeChunkStore(const std::string& storePath, std::vector<BlobEntry>& entries,
+                             std::vector<std::pair<std::uint64_t, std::uint32_t>>& segments,
+                             std::uint64_t& storeSize);
+        bool generateRegistrySource(const std::vector<std::pair<unsigned, std::uint64_t>>& generated) const;
 
         std::string sanitizeIdentifier(const std::string& input) const;
 
@@ -27,5 +151,24 @@ namespace resman
         std::string mOutputCppDir;
         std::vector<std::string> mResSearchPaths;
         std::vector<ResourceInfo> mResInfo;
+        std::vector<std::string> mResolvedPaths;
+        std::vector<std::string> mMissingPaths;
+        std::vector<std::pair<unsigned, std::string>> mGeneratedSources;
+        std::map<std::string, std::string> mResData;
+        bool mEmitRegistry = false;
+        bool mDevMode = false;
+        bool mDedupContent = false;
+        bool mBlobLayout = false;
+        bool mChunkDedup = false;
+        std::string mBlobIndexSymbol = "resman_lite_blob_index";
+        unsigned mThreadCount = 0;
+        std::uint64_t mMaxBytesInFlight = 256ull << 20;
+
+        // between beginGeneration() and finishGeneration()
+        std::vector<std::string> mBaseNames;
+        std::vector<GeneratedResource> mResults;
+        std::unique_ptr<ByteBudget> mBudget;
+
+        ResLogger mLog{ "ResCppSrcGenerator" };
     };
 }
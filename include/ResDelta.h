@@ -0,0 +1,72 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include "ResLog.h"
+
+namespace resman
+{
+    // Binary deltas between two builds' outputs (objects, archives, bitcode),
+    // for shipping asset updates to machines that have the previous build.
+    //
+    // Both files are split into content-defined chunks (ResChunker.h), so the
+    // bytes of an unchanged resource form the same chunks wherever the new
+    // build placed them. Runs of chunks found in the old file are referenced by
+    // the content hash of their first chunk. Chunks that changed are compared
+    // with the old bytes at the same relative position: identical stretches are
+    // copied from the old file, only the differing ones are stored. The delta
+    // records the hashes of both files, so applying it to the wrong base, or a
+    // corrupted result, is detected.
+    //
+    // Format (integers little-endian):
+    //     "RMDELTA1", u64 old size, old SHA-256, u64 new size, new SHA-256
+    //     then ops:  1 ref   : 16-byte chunk hash, u64 length
+    //                2 copy  : u64 old offset, u64 length
+    //                3 data  : u64 length, bytes
+    //                0 end
+    class ResDeltaGenerator
+    {
+    public:
+        ResDeltaGenerator& setOldFile(const std::string& path);
+        ResDeltaGenerator& setNewFile(const std::string& path);
+        ResDeltaGenerator& setDeltaFile(const std::string& path);
+
+        ResDeltaGenerator& setLogCallback(LogCallback callback);
+
+        bool run();
+
+    private:
+        bool validateInputs() const;
+
+    private:
+        std::string mOldFile;
+        std::string mNewFile;
+        std::string mDeltaFile;
+
+        ResLogger mLog{ "ResDeltaGenerator" };
+    };
+
+    // Rebuilds the new file from the old one and a delta of ResDeltaGenerator
+    class ResDeltaApplier
+    {
+    public:
+        ResDeltaApplier& setOldFile(const std::string& path);
+        ResDeltaApplier& setDeltaFile(const std::string& path);
+        ResDeltaApplier& setOutputFile(const std::string& path);
+
+        ResDeltaApplier& setLogCallback(LogCallback callback);
+
+        // The output is only moved into place once its hash matches the delta
+        bool run();
+
+    private:
+        bool validateInputs() const;
+
+    private:
+        std::string mOldFile;
+        std::string mDeltaFile;
+        std::string mOutputFile;
+
+        ResLogger mLog{ "ResDeltaApplier" };
+    };
+}
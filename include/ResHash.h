@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <optional>
+
+namespace resman
+{
+    // Incremental SHA-256, used for cache keys and content addressing
+    class ResHasher
+    {
+    public:
+        ResHasher();
+
+        ResHasher& update(const void* data, std::size_t size);
+        ResHasher& update(const std::string& data);
+
+        // Length-prefixed, so consecutive fields can't run into each other
+        ResHasher& updateField(const std::string& field);
+
+        // Finalizes the hash; the hasher must not be updated afterwards
+        std::string hexDigest();
+
+        static std::optional<std::string> hashFile(const std::string& path);
+        static std::string hashString(const std::string& data);
+
+    private:
+        void processBlock(const unsigned char* block);
+
+    private:
+        uint32_t mState[8];
+        unsigned char mBuffer[64];
+        std::size_t mBufferLen = 0;
+        uint64_t mTotalLen = 0;
+    };
+}
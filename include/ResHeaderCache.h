@@ -0,0 +1,59 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "ResASTJsonParser.h" // for ResourceInfo
+#include "ResLog.h"
+
+namespace resman
+{
+    // Caches the ResourceInfo list extracted from a resource header, so an
+    // unchanged header skips both the clang AST dump and ResASTJsonParser.
+    //
+    // Entries are keyed by the header, include paths, defines and clang version;
+    // each entry also records the content hash of every file clang reported as a
+    // dependency, and is only a hit while all of them are unchanged.
+    class ResHeaderCache
+    {
+    public:
+        ResHeaderCache& setCacheDir(const std::string& dir);
+        ResHeaderCache& setWorkingDir(const std::string& dir);  // scratch files (clang --version output)
+        ResHeaderCache& setClangPath(const std::string& path);
+        ResHeaderCache& setHeaderFile(const std::string& path);
+        ResHeaderCache& addIncludePath(const std::string& includeDir);
+        ResHeaderCache& addIncludePath(const std::vector<std::string>& includeDir);
+        ResHeaderCache& addDefine(const std::string& define);
+        ResHeaderCache& addDefine(const std::vector<std::string>& define);
+
+        ResHeaderCache& setLogCallback(LogCallback callback);
+
+        // true on a hit, with the cached resources in `resources`
+        bool lookup(std::vector<ResourceInfo>& resources);
+
+        // Dependencies recorded in the entry returned by the last successful lookup()
+        const std::vector<std::string>& getDependencies() const noexcept { return mDependencies; }
+
+        // dependencies: files the header depends on (ResHeaderParser::getDependencies)
+        bool store(const std::vector<ResourceInfo>& resources, const std::vector<std::string>& dependencies);
+
+    private:
+        bool validateInputs() const;
+        std::string computeKey();
+        std::string queryClangVersion() const;
+        std::string entryPath();
+
+    private:
+        std::string mCacheDir;
+        std::string mWorkingDir;
+        std::string mClangPath;
+        std::string mHeaderFile;
+
+        std::vector<std::string> mIncludeDirs;
+        std::vector<std::string> mDefines;
+
+        std::string mKey;   // computed once per instance
+        std::vector<std::string> mDependencies;
+
+        ResLogger mLog{ "ResHeaderCache" };
+    };
+}
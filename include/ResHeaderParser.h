@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <optional>
+#include "ResLog.h"
 
 namespace resman
 {
@@ -13,17 +14,26 @@ namespace resman
         ResHeaderParser& setClangPath(const std::string& path);
         ResHeaderParser& setHeaderFile(const std::string& path);
         ResHeaderParser& setOutputJson(const std::string& path);
+        ResHeaderParser& setDepFile(const std::string& path);   // optional, make-style dependency output
         ResHeaderParser& addIncludePath(const std::string& includeDir);
         ResHeaderParser& addIncludePath(const std::vector<std::string>& includeDir);
         ResHeaderParser& addDefine(const std::string& define);
         ResHeaderParser& addDefine(const std::vector<std::string>& define);
 
+        ResHeaderParser& setLogCallback(LogCallback callback);
+
         // Execute the parsing step
         bool run();
 
         // get system command
         std::string getCommandLine() const;
 
+        // Files the header pulled in (header included), read from the dep file after run()
+        const std::vector<std::string>& getDependencies() const noexcept { return mDependencies; }
+
+        // Parses a make-style dependency file ("target: dep dep \")
+        static std::vector<std::string> parseDepFile(const std::string& path);
+
     private:
         // Internal helpers
         bool validateInputs() const;
@@ -33,8 +43,12 @@ namespace resman
         std::string mClangPath;
         std::string mHeaderFile;
         std::string mOutputJson;
+        std::string mDepFile;
 
         std::vector<std::string> mIncludeDirs;
         std::vector<std::string> mDefines;
+        std::vector<std::string> mDependencies;
+
+        ResLogger mLog{ "ResHeaderParser" };
     };
 }
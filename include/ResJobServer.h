@@ -0,0 +1,78 @@
+#pragma once
+
+#include <string>
+#include <atomic>
+
+namespace resman
+{
+    // GNU make jobserver client. When resman-lite runs under `make -jN` (or
+    // another jobserver-aware build tool), every subprocess and worker task
+    // holds a job token, so the outer build's job limit covers our own
+    // parallelism too.
+    //
+    // The server is found through MAKEFLAGS: --jobserver-auth=fifo:PATH
+    // (make >= 4.4), --jobserver-auth=R,W / --jobserver-fds=R,W (inherited
+    // pipe) or, on Windows, --jobserver-auth=NAME (named semaphore). Without
+    // one, acquire() never blocks.
+    class ResJobServer
+    {
+    public:
+        // A job slot, returned to the server when destroyed
+        class Token
+        {
+        public:
+            Token() = default;
+            Token(Token&& other) noexcept;
+            Token& operator=(Token&& other) noexcept;
+            Token(const Token&) = delete;
+            Token& operator=(const Token&) = delete;
+            ~Token();
+
+        private:
+            friend class ResJobServer;
+            enum class Kind { None, Implicit, Shared };
+
+            Token(ResJobServer* server, Kind kind, char byte) : mServer(server), mKind(kind), mByte(byte) {}
+            void release();
+
+            ResJobServer* mServer = nullptr;
+            Kind mKind = Kind::None;
+            char mByte = '+';   // handed back unchanged, make uses it for its exit status
+        };
+
+        // The process-wide client, set up from MAKEFLAGS on first use. Call it
+        // before opening any file (main() does), so descriptors inherited from
+        // make can't be confused with files the process opened itself.
+        static ResJobServer& instance();
+
+        bool active() const noexcept { return mActive.load(); }
+        const std::string& description() const noexcept { return mDescription; }
+
+        // Blocks until a job slot is free. The first concurrent holder uses the
+        // slot make implicitly granted this process, the others take a token.
+        Token acquire();
+
+    private:
+        ResJobServer();
+        ~ResJobServer();
+        ResJobServer(const ResJobServer&) = delete;
+        ResJobServer& operator=(const ResJobServer&) = delete;
+
+        bool connect(const std::string& auth);
+        bool readToken(char& byte);
+        void writeToken(char byte);
+
+    private:
+        std::atomic<bool> mActive{ false };
+        std::string mDescription;
+        std::atomic<bool> mImplicitTaken{ false };
+
+#if defined(_WIN32)
+        void* mSemaphore = nullptr;
+#else
+        int mReadFd = -1;
+        int mWriteFd = -1;
+        bool mOwnsFds = false;  // opened from a fifo path
+#endif
+    };
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include "ResLog.h"
+
+namespace resman
+{
+    // Access profiles written by programs built with -DRESMAN_PROFILE, used to
+    // lay resources out in the order they are first needed.
+    //
+    // Resources accessed in the profiles come first, by (average, across
+    // profiles) relative first-access position, so resources loaded together
+    // end up on neighbouring pages. Resources never accessed go last.
+    class ResLayoutProfile
+    {
+    public:
+        // May be called for several profiles (e.g. different runs or platforms)
+        ResLayoutProfile& addProfile(const std::string& path);
+
+        ResLayoutProfile& setLogCallback(LogCallback callback);
+
+        bool load();
+
+        // ids reordered by the profiles; unprofiled ids keep their relative order
+        std::vector<unsigned> order(const std::vector<unsigned>& ids) const;
+
+    private:
+        struct Usage
+        {
+            double rankSum = 0;         // relative first-access positions, in [0, 1)
+            unsigned profiles = 0;
+            unsigned long long count = 0;
+        };
+
+        bool loadProfile(const std::string& path);
+
+    private:
+        std::vector<std::string> mProfilePaths;
+        std::map<unsigned, Usage> mUsage;
+
+        ResLogger mLog{ "ResLayoutProfile" };
+    };
+}
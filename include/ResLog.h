@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <sstream>
+#include <functional>
+
+namespace resman
+{
+    enum class LogLevel
+    {
+        Info,
+        Warning,
+        Error
+    };
+
+    // Receives every progress/diagnostic message of the pipeline. May be
+    // called from worker threads (e.g. concurrent llc runs). Each pipeline
+    // class takes one through setLogCallback(); without it, messages go to
+    // defaultLogCallback (std::cout / std::cerr).
+    using LogCallback = std::function<void(LogLevel level, const std::string& component, const std::string& message)>;
+
+    // Prints "[component] message" to std::cout (info) or std::cerr
+    void defaultLogCallback(LogLevel level, const std::string& component, const std::string& message);
+
+    class ResLogger
+    {
+    public:
+        // Collects one message and hands it to the callback when it goes out of scope
+        class Line
+        {
+        public:
+            Line(const ResLogger& logger, LogLevel level) : mLogger(logger), mLevel(level) {}
+            Line(const Line&) = delete;
+            ~Line() { mLogger.log(mLevel, mStream.str()); }
+
+            template <typename T>
+            Line& operator<<(const T& value)
+            {
+                mStream << value;
+                return *this;
+            }
+
+        private:
+            const ResLogger& mLogger;
+            LogLevel mLevel;
+            std::ostringstream mStream;
+        };
+
+        explicit ResLogger(std::string component) : mComponent(std::move(component)) {}
+
+        void setCallback(LogCallback callback) { mCallback = std::move(callback); }
+        const LogCallback& getCallback() const noexcept { return mCallback; }
+
+        Line info() const { return Line(*this, LogLevel::Info); }
+        Line warning() const { return Line(*this, LogLevel::Warning); }
+        Line error() const { return Line(*this, LogLevel::Error); }
+
+        void log(LogLevel level, const std::string& message) const;
+
+    private:
+        std::string mComponent;
+        LogCallback mCallback;   // empty: defaultLogCallback
+    };
+}
@@ -2,9 +2,22 @@
 
 #include <string>
 #include <vector>
+#include <map>
+#include <mutex>
+#include <cstdint>
+#include "ResLog.h"
+#include "ResObjectCache.h"
 
 namespace resman
 {
+    // What ResObjGenerator writes to the output path
+    enum class ObjOutputKind
+    {
+        Object,         // llc -filetype=obj (default)
+        Bitcode,        // the llvm-link'ed module, for full LTO
+        ThinBitcode     // archive of per-resource ThinLTO modules (with summaries)
+    };
+
     class ResObjGenerator
     {
     public:
@@ -12,21 +25,93 @@ namespace resman
         ResObjGenerator& setLlvmAsPath(const std::string& path);
         ResObjGenerator& setLlvmLinkPath(const std::string& path);
         ResObjGenerator& setLlcPath(const std::string& path);
+        ResObjGenerator& setLlvmArPath(const std::string& path);
         
         ResObjGenerator& setInputCppDir(const std::string& dir);
         ResObjGenerator& setWorkingDir(const std::string& dir);
         ResObjGenerator& setOutputObj(const std::string& path);
         ResObjGenerator& setTargetTriple(const std::string& triple);
 
+        // Additional target triples; with more than one triple, one object per
+        // triple is written to <obj-stem>.<triple><obj-ext>
+        ResObjGenerator& addTargetTriple(const std::string& triple);
+        ResObjGenerator& addTargetTriple(const std::vector<std::string>& triples);
+
+        // Keep an existing output (and its mtime) when the new object is byte-identical
+        ResObjGenerator& setWriteIfChanged(bool enable);
+
+        ResObjGenerator& setOutputKind(ObjOutputKind kind);
+
+        // Sources linked first, in this order (the data is laid out in link
+        // order); the rest follow sorted by name
+        ResObjGenerator& setCppFileOrder(const std::vector<std::string>& cppFiles);
+
+        // Shared cache of per-resource bitcode and final outputs (disabled if empty)
+        ResObjGenerator& setObjectCacheDir(const std::string& dir);
+        ResObjGenerator& setObjectCacheMaxBytes(std::uint64_t bytes);
+
         // Include directories
         ResObjGenerator& addIncludePath(const std::string& path);
         ResObjGenerator& addIncludePath(const std::vector<std::string>& paths);
 
+        ResObjGenerator& setLogCallback(LogCallback callback);
+
         bool run();
 
+        // Stepwise build, for callers that compile each source as soon as it is
+        // written (run() does all three): beginBuild() once, compileModule() per
+        // source from any thread, then finishBuild(), which compiles the sources
+        // not handed to compileModule() and links everything in link order.
+        bool beginBuild();
+        bool compileModule(const std::string& cppFile);
+        bool finishBuild();
+
+        // Object path written for a given triple
+        std::string getOutputObjPath(const std::string& triple) const;
+
     private:
+        // Triples that can share one LLVM IR module (same C++ ABI, pointer width
+        // and object format). Only data is shared: a module defining functions
+        // is compiled again for each triple of the group.
+        struct FrontendGroup
+        {
+            std::string frontendTriple;             // triple passed to clang
+            std::vector<std::string> targetTriples; // triples passed to llc
+            std::string workingDir;
+        };
+
         bool validateInputs() const;
         bool generateObjectFile() const;
+        std::vector<FrontendGroup> groupTargetTriples() const;
+        // Per-resource bitcode of one frontend group
+        struct CompiledModule
+        {
+            std::string cacheKey;
+            std::string bcFile;
+            std::vector<std::string> tripleBcFiles;   // per target triple, if the module has code
+        };
+
+        bool compileGroupModule(const std::string& cppFile, const std::string& moduleKey,
+                                const FrontendGroup& group, CompiledModule& module) const;
+        bool compileBitcodeModule(const std::string& cppFile, const std::string& moduleKey,
+                                  const FrontendGroup& group, std::string& bcFile, bool& definesFunctions) const;
+        bool prepareSharedModule(const std::string& llFile, bool& definesFunctions) const;
+        const CompiledModule* findCompiledModule(const std::string& cppFile, size_t groupIndex) const;
+        bool normalizeModuleSource(const std::string& llFile, const std::string& sourceName) const;
+        bool linkBitcodeModules(const std::vector<std::string>& bcFiles, const FrontendGroup& group,
+                                std::string& mergedBC) const;
+        bool emitObject(const std::string& mergedBC, const std::string& triple, const std::string& cacheKey) const;
+        bool emitBitcode(const std::string& mergedBC, const std::string& triple, const std::string& cacheKey) const;
+        bool emitBitcodeArchive(const std::vector<std::string>& bcFiles, const std::string& triple,
+                                const std::string& cacheKey) const;
+        std::string stagingPath(const std::string& outputPath) const;
+        bool commitOutput(const std::string& stagedPath, const std::string& outputPath) const;
+
+        // object cache keys; empty when caching is off or the input can't be cached
+        std::string moduleCacheKey(const std::string& cppFile, const FrontendGroup& group) const;
+        std::string outputCacheKey(const std::vector<std::string>& moduleKeys, const std::string& triple) const;
+        std::string runtimeHeaderHash() const;
+        bool restoreOutput(const std::string& cacheKey, const std::string& triple) const;
         bool invokeCmd(const std::string& cmd, const std::string& stepDesc) const;
         std::vector<std::string> collectCppFiles() const;
         std::string quote(const std::string& path) const;
@@ -36,12 +121,25 @@ namespace resman
         std::string mLlvmAsPath;
         std::string mLlvmLinkPath;
         std::string mLlcPath;
+        std::string mLlvmArPath;
 
         std::string mInputCppDir;   // where all resource .cpp files are
         std::string mWorkingDir;    // where .ll and .bc intermediates go
         std::string mOutputObj;     // final .obj/.o/.lib/.a
-        std::string mTargetTriple;  // optional target triple
+        std::vector<std::string> mTargetTriples;  // optional target triples (host if empty)
 
         std::vector<std::string> mIncludePaths;   // include directories
+        std::vector<std::string> mCppFileOrder;
+        bool mWriteIfChanged = false;
+        ObjOutputKind mOutputKind = ObjOutputKind::Object;
+        ResObjectCache mObjectCache;
+
+        // between beginBuild() and finishBuild()
+        std::vector<FrontendGroup> mGroups;
+        std::string mRuntimeHeaderHash;     // part of every module key
+        std::map<std::string, std::vector<CompiledModule>> mCompiledModules;   // .cpp file name -> per group
+        mutable std::mutex mCompiledMutex;
+
+        ResLogger mLog{ "ResObjGenerator" };
     };
 }
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include "ResLog.h"
+
+namespace resman
+{
+    // Content-addressed store of compiled artifacts (per-resource bitcode and
+    // final outputs), shareable between projects, parallel jobs and CI runs.
+    //
+    // Keys are computed by the caller and must cover everything the artifact
+    // depends on. Entries are written with write-then-rename and read by
+    // copying, so concurrent users never see a partial entry. The least
+    // recently used entries are evicted by trim() once the cache grows past
+    // its maximum size.
+    class ResObjectCache
+    {
+    public:
+        ResObjectCache& setCacheDir(const std::string& dir);
+        ResObjectCache& setMaxBytes(std::uint64_t bytes);
+
+        ResObjectCache& setLogCallback(LogCallback callback);
+
+        bool enabled() const noexcept { return !mCacheDir.empty(); }
+
+        // true on a hit, with the entry copied to destPath
+        bool fetch(const std::string& key, const std::string& destPath) const;
+        bool store(const std::string& key, const std::string& srcPath) const;
+
+        // Evicts least recently used entries until the cache fits in its maximum size
+        void trim() const;
+
+    private:
+        std::string entryPath(const std::string& key) const;
+
+    private:
+        std::string mCacheDir;
+        std::uint64_t mMaxBytes = 2ull << 30;
+
+        ResLogger mLog{ "ResObjectCache" };
+    };
+}
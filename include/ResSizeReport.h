@@ -0,0 +1,82 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "ResLog.h"
+
+namespace resman
+{
+    // One declared resource in a size report
+    struct ResourceSizeEntry
+    {
+        unsigned id = 0;
+        std::string name;                   // variable name
+        std::string header;                 // declaring header (empty for in-memory resource info)
+        std::string path;                   // resource path as declared
+        bool embedded = false;              // false: not found, nothing embedded
+        std::uint64_t rawBytes = 0;         // the resource file
+        std::uint64_t sourceBytes = 0;      // generated source compiled for it
+        std::uint64_t emittedBytes = 0;     // bytes it adds to the output's data
+    };
+
+    // Where the bytes of a build go: per resource and per declaring header,
+    // largest first, written as JSON (for tooling and later comparisons) and
+    // as text. Optionally compared with a previous report, and checked
+    // against a budget file so a build fails when it grows past a limit.
+    //
+    // Budget file (JSON; sizes are byte counts or strings like "512K", "4M", "1G"):
+    //     {
+    //         "total": "64M",                              // all emitted bytes
+    //         "resource": "8M",                            // any single resource
+    //         "resources": { "video/intro.webm": "24M" },  // by declared path, variable name or id
+    //         "headers": { "ui_resources.h": "16M" }       // by header path or file name
+    //     }
+    class ResSizeReport
+    {
+    public:
+        ResSizeReport& addResource(const ResourceSizeEntry& entry);
+
+        // Object, bitcode or archive written by the build, sized on disk
+        ResSizeReport& addOutput(const std::string& path);
+
+        // Report (JSON) of an earlier build to list the changes against
+        ResSizeReport& setBaseline(const std::string& path);
+
+        ResSizeReport& setLogCallback(LogCallback callback);
+
+        // JSON to path, text next to it (.txt); a summary goes to the log
+        bool write(const std::string& path) const;
+
+        // Every exceeded limit is reported as an error; false if any was
+        bool checkBudget(const std::string& budgetPath) const;
+
+    private:
+        struct HeaderTotal
+        {
+            std::string header;
+            size_t count = 0;
+            std::uint64_t rawBytes = 0;
+            std::uint64_t sourceBytes = 0;
+            std::uint64_t emittedBytes = 0;
+        };
+
+        struct Change
+        {
+            std::string path;
+            std::int64_t before = -1;       // -1: not in that build
+            std::int64_t after = -1;
+        };
+
+        std::vector<ResourceSizeEntry> sortedResources() const;
+        std::vector<HeaderTotal> headerTotals() const;
+        bool loadBaseline(std::vector<Change>& changes) const;
+
+    private:
+        std::vector<ResourceSizeEntry> mResources;
+        std::vector<std::pair<std::string, std::uint64_t>> mOutputs;
+        std::string mBaselinePath;
+
+        ResLogger mLog{ "ResSizeReport" };
+    };
+}
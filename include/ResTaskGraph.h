@@ -0,0 +1,70 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include "ResLog.h"
+
+namespace resman
+{
+    // Dependency graph of build tasks, run on a work-stealing thread pool.
+    //
+    // A task becomes ready once all of its dependencies have finished. Tasks
+    // it unblocks are queued on the worker that ran it (newest first), so a
+    // resource tends to flow through its stages on one thread while other
+    // workers steal the oldest pending work. After a task fails, the rest are
+    // drained without running and run() returns false. An exception thrown
+    // by a task is logged and counts as its failure.
+    class ResTaskGraph
+    {
+    public:
+        using TaskId = size_t;
+
+        // 0: one worker per core
+        explicit ResTaskGraph(unsigned threadCount = 0);
+
+        ResTaskGraph& setLogCallback(LogCallback callback);
+
+        TaskId addTask(std::function<bool()> fn, const std::vector<TaskId>& dependencies = {});
+
+        // Runs every task; may be called once
+        bool run();
+
+    private:
+        struct Task
+        {
+            std::function<bool()> fn;
+            std::vector<TaskId> dependents;
+            std::atomic<size_t> pending{ 0 };
+        };
+
+        struct Worker
+        {
+            std::mutex mutex;
+            std::deque<TaskId> queue;
+        };
+
+        void workerLoop(unsigned index);
+        bool takeTask(unsigned index, TaskId& task);
+        void pushTask(unsigned index, TaskId task);
+        void finishTask(unsigned index, TaskId task);
+
+    private:
+        unsigned mThreadCount;
+        std::vector<std::unique_ptr<Task>> mTasks;
+        std::vector<std::unique_ptr<Worker>> mWorkers;
+
+        std::atomic<size_t> mRemaining{ 0 };
+        std::atomic<size_t> mQueued{ 0 };
+        std::atomic<bool> mFailed{ false };
+
+        std::mutex mIdleMutex;
+        std::condition_variable mIdleCond;
+
+        ResLogger mLog{ "ResTaskGraph" };
+    };
+}
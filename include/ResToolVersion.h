@@ -0,0 +1,13 @@
+#pragma once
+
+#include <string>
+
+namespace resman
+{
+    // `<tool> --version` output reduced to its tool name, version and default
+    // target lines (no host CPU or install dir, so machines share cache keys),
+    // or "" if the tool can't be run. Memoized per tool path for the lifetime
+    // of the process; safe to call from any thread. scratchDir holds the
+    // temporary output file (temp directory if empty).
+    std::string queryToolVersion(const std::string& toolPath, const std::string& scratchDir = "");
+}
@@ -1,8 +1,314 @@
 #pragma once
 
+#include <cstddef>
+
+#if defined(__has_include)
+#if __has_include(<version>)
+#include <version>
+#endif
+#endif
+
+#if defined(__cpp_lib_string_view) || __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#include <iterator>
+#include <string_view>
+#define RESMAN_HAS_STRING_VIEW 1
+#endif
+
+#if defined(__cpp_lib_span)
+#include <span>
+#endif
+
+namespace resman {
+	namespace detail {
+		struct DataView {
+			const char* data;
+			std::size_t size;
+		};
+	}
+}
+
+#if defined(RESMAN_DEV_MODE)
+#include "resman_dev.h"
+#elif defined(RESMAN_BLOB_LAYOUT)
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <new>
+#endif
+
+#if defined(RESMAN_PROFILE)
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#endif
+
 namespace resman {
 	// fwd
 	class ResourceHandle;
+	namespace detail { struct ResourceAccess; }
+	namespace detail { template <typename T> struct DecodeResult; }
+
+	namespace detail {
+#if defined(RESMAN_PROFILE)
+		// Built with -DRESMAN_PROFILE, the first access and the access count of
+		// every resource are recorded and written at exit to $RESMAN_PROFILE_FILE
+		// (default resman-profile.txt), for resman-lite --layout-profile.
+		class AccessProfile {
+		public:
+			static AccessProfile& instance() {
+				static AccessProfile profile;
+				return profile;
+			}
+
+			void record(unsigned id) noexcept {
+				try {
+					std::lock_guard<std::mutex> lock(m_mutex);
+					Record& rec = m_records[id];
+					if (rec.count++ == 0) {
+						rec.first_access = m_next_access++;
+						rec.first_access_us = static_cast<unsigned long long>(
+							std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count());
+					}
+				}
+				catch (...) {
+				}
+			}
+
+			bool write(const char* path) const {
+				std::FILE* file = std::fopen(path, "w");
+				if (!file)
+					return false;
+
+				std::lock_guard<std::mutex> lock(m_mutex);
+				std::fprintf(file, "# resman-lite access profile v1\n# id first_access count first_access_us\n");
+				for (const auto& entry : m_records)
+					std::fprintf(file, "%u %llu %llu %llu\n", entry.first, entry.second.first_access,
+						entry.second.count, entry.second.first_access_us);
+				return std::fclose(file) == 0;
+			}
+
+			~AccessProfile() {
+				const char* path = std::getenv("RESMAN_PROFILE_FILE");
+				write(path && *path ? path : "resman-profile.txt");
+			}
+
+		private:
+			struct Record {
+				unsigned long long first_access = 0;
+				unsigned long long count = 0;
+				unsigned long long first_access_us = 0;
+			};
+
+			AccessProfile() = default;
+
+			mutable std::mutex m_mutex;
+			std::map<unsigned, Record> m_records;
+			unsigned long long m_next_access = 0;
+			std::chrono::steady_clock::time_point m_start = std::chrono::steady_clock::now();
+		};
+
+		inline void on_access(unsigned id) noexcept {
+			AccessProfile::instance().record(id);
+		}
+#else
+		inline void on_access(unsigned) noexcept {}
+#endif
+
+#if defined(RESMAN_BLOB_LAYOUT) && !defined(RESMAN_DEV_MODE)
+		// Built with --blob-layout, each generated object holds its resources in
+		// one blob and a constant-initialized index, with offsets relative to the
+		// blob (no relocations) and entries sorted by id.
+		struct BlobEntry32 {
+			std::uint32_t id;
+			std::uint32_t offset;
+			std::uint32_t size;
+		};
+
+		struct BlobEntry64 {
+			std::uint32_t id;
+			std::uint64_t offset;
+			std::uint64_t size;
+		};
+
+		// --chunk-dedup: a piece of the blob; a resource is a run of consecutive segments
+		struct BlobSegment {
+			std::uint64_t offset;
+			std::uint32_t size;
+		};
+
+		struct BlobIndex {
+			const char* blob;
+			const BlobEntry32* entries32;	// one of the two, by blob size
+			const BlobEntry64* entries64;
+			const BlobSegment* segments;	// with --chunk-dedup, entry offsets index these
+			std::atomic<const char*>* assembled;	// with --chunk-dedup, per entry, null until assembled
+			std::size_t count;
+		};
+
+		inline unsigned blob_entry_id(const BlobIndex& index, std::size_t i) noexcept {
+			return index.entries32 ? index.entries32[i].id : index.entries64[i].id;
+		}
+
+		inline void blob_entry_extent(const BlobIndex& index, std::size_t i, std::uint64_t& offset, std::size_t& size) noexcept {
+			offset = index.entries32 ? index.entries32[i].offset : index.entries64[i].offset;
+			size = index.entries32 ? index.entries32[i].size : static_cast<std::size_t>(index.entries64[i].size);
+		}
+
+		// Resources split into several segments are copied together once, on
+		// first access, into a buffer kept for the rest of the program. The
+		// buffer is published in the entry's slot, so later reads take no lock;
+		// threads racing on the first access each assemble it, and one buffer
+		// wins. Running out of memory there terminates, as a throwing new would
+		// in these noexcept accessors.
+		inline DataView blob_entry_view(const BlobIndex& index, std::size_t i) noexcept {
+			std::uint64_t offset;
+			std::size_t size;
+			blob_entry_extent(index, i, offset, size);
+			if (!index.segments)
+				return { index.blob + offset, size };
+			if (size == 0)
+				return { "", 0 };
+
+			const BlobSegment* first = index.segments + offset;
+			if (first->size == size)
+				return { index.blob + first->offset, size };
+
+			std::atomic<const char*>& slot = index.assembled[i];
+			const char* data = slot.load(std::memory_order_acquire);
+			if (data)
+				return { data, size };
+
+			char* buffer = new (std::nothrow) char[size + 1];
+			if (!buffer) {
+				std::fprintf(stderr, "resman: cannot allocate %llu bytes to assemble resource %u\n",
+					static_cast<unsigned long long>(size), blob_entry_id(index, i));
+				std::terminate();
+			}
+			std::size_t pos = 0;
+			for (const BlobSegment* seg = first; pos < size; ++seg) {
+				std::memcpy(buffer + pos, index.blob + seg->offset, seg->size);
+				pos += seg->size;
+			}
+			buffer[size] = '\0';
+
+			if (!slot.compare_exchange_strong(data, buffer, std::memory_order_acq_rel, std::memory_order_acquire)) {
+				delete[] buffer;
+				return { data, size };
+			}
+			return { buffer, size };
+		}
+
+		// Each blob object defines its index under one extern "C" name and puts a
+		// pointer to it into a section, which the linker gathers into a table per
+		// binary (executable or shared library); nothing is registered at run
+		// time. Slots may be null: section padding, the COFF bounds.
+#if defined(__GNUC__) || defined(__clang__)
+#if defined(__APPLE__)
+#define RESMAN_BLOB_TABLE_SLOT __attribute__((used, section("__DATA,__resman_blobs")))
+#elif defined(_WIN32)
+#define RESMAN_BLOB_TABLE_SLOT __attribute__((used, section(".rdata$resman_lite_blobs$m")))
+#define RESMAN_BLOB_TABLE_BOUND(suffix) __attribute__((selectany, section(".rdata$resman_lite_blobs$" suffix)))
+#elif defined(__has_attribute)
+#if __has_attribute(retain)
+#define RESMAN_BLOB_TABLE_SLOT __attribute__((used, retain, section("resman_lite_blobs")))
+#endif
+#endif
+#if !defined(RESMAN_BLOB_TABLE_SLOT)
+#define RESMAN_BLOB_TABLE_SLOT __attribute__((used, section("resman_lite_blobs")))
+#endif
+#endif
+
+#if defined(__APPLE__)
+		extern "C" const BlobIndex* const resman_lite_blobs_begin[] __asm("section$start$__DATA$__resman_blobs");
+		extern "C" const BlobIndex* const resman_lite_blobs_end[] __asm("section$end$__DATA$__resman_blobs");
+
+		inline const BlobIndex* const* blob_table_begin() noexcept { return resman_lite_blobs_begin; }
+		inline const BlobIndex* const* blob_table_end() noexcept { return resman_lite_blobs_end; }
+#elif defined(_WIN32)
+		extern "C" const BlobIndex* const resman_lite_blobs_begin[];
+		extern "C" const BlobIndex* const resman_lite_blobs_end[];
+
+		inline const BlobIndex* const* blob_table_begin() noexcept { return resman_lite_blobs_begin; }
+		inline const BlobIndex* const* blob_table_end() noexcept { return resman_lite_blobs_end; }
+#else
+		extern "C" __attribute__((visibility("hidden"))) const BlobIndex* const __start_resman_lite_blobs[];
+		extern "C" __attribute__((visibility("hidden"))) const BlobIndex* const __stop_resman_lite_blobs[];
+
+		inline const BlobIndex* const* blob_table_begin() noexcept { return __start_resman_lite_blobs; }
+		inline const BlobIndex* const* blob_table_end() noexcept { return __stop_resman_lite_blobs; }
+#endif
+
+		// A binary search per blob object of the binary
+		inline bool blob_find(unsigned id, const BlobIndex*& index, std::size_t& position) noexcept {
+			for (const BlobIndex* const* slot = blob_table_begin(); slot != blob_table_end(); ++slot) {
+				const BlobIndex* candidate = *slot;
+				if (!candidate)
+					continue;
+
+				std::size_t first = 0;
+				std::size_t last = candidate->count;
+				while (first < last) {
+					const std::size_t mid = first + (last - first) / 2;
+					if (blob_entry_id(*candidate, mid) < id)
+						first = mid + 1;
+					else
+						last = mid;
+				}
+				if (first < candidate->count && blob_entry_id(*candidate, first) == id) {
+					index = candidate;
+					position = first;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// Without assembling a segmented resource
+		inline std::size_t blob_size(unsigned id) noexcept {
+			const BlobIndex* index;
+			std::size_t position;
+			if (!blob_find(id, index, position))
+				return 0;
+
+			std::uint64_t offset;
+			std::size_t size;
+			blob_entry_extent(*index, position, offset, size);
+			return size;
+		}
+
+		// A resource whose object is not linked in reads as empty
+		inline DataView blob_view(unsigned id) noexcept {
+			const BlobIndex* index;
+			std::size_t position;
+			if (!blob_find(id, index, position))
+				return { "", 0 };
+			return blob_entry_view(*index, position);
+		}
+
+		// Calls fn(data, size) per stored segment, without assembling; false if not segmented
+		template <typename F>
+		bool blob_segments(unsigned id, F& fn) {
+			const BlobIndex* index;
+			std::size_t position;
+			if (!blob_find(id, index, position) || !index->segments)
+				return false;
+
+			std::uint64_t offset;
+			std::size_t size;
+			blob_entry_extent(*index, position, offset, size);
+			std::size_t pos = 0;
+			for (const BlobSegment* seg = index->segments + offset; pos < size; ++seg) {
+				fn(index->blob + seg->offset, static_cast<std::size_t>(seg->size));
+				pos += seg->size;
+			}
+			return true;
+		}
+#endif
+	}
 
 	template <unsigned N>
 	struct Resource {
@@ -11,37 +317,296 @@ namespace resman {
 
 	private:
 		friend ResourceHandle;
+		friend detail::ResourceAccess;
 
+#if defined(RESMAN_DEV_MODE)
+		// built with --dev-mode: the file is mapped from disk on first access
+		static const detail::DevResourceInfo storage_info;
+#elif defined(RESMAN_BLOB_LAYOUT)
+		// built with --blob-layout: no symbol per resource, it is looked up by
+		// id in the blob indexes of the binary
+#elif defined(RESMAN_DEDUP_CONTENT)
+		// built with --dedup-content: the bytes are a content-keyed COMDAT symbol,
+		// linked once however many objects and libraries embed the same data
+		static const detail::DataView storage_view;
+#else
 		static const char storage_begin[];
-		static const unsigned storage_size;
+		static const std::size_t storage_size;
+#endif
 	};
 
+	// A view of one embedded resource. Trivially copyable (pass it by value)
+	// and constexpr-constructible, so handles can be constant-initialized.
 	class ResourceHandle {
-		const unsigned res_id = 0;
-		const unsigned res_byte_size = 0;
-		const char* res_begin_ptr = nullptr;
-		const char* res_end_ptr = nullptr;
+#if defined(RESMAN_DEV_MODE)
+		const detail::DevResourceInfo* res_info;
+#elif defined(RESMAN_BLOB_LAYOUT)
+		// --blob-layout: just res_id, looked up in the blob indexes
+#elif defined(RESMAN_DEDUP_CONTENT)
+		const detail::DataView* res_view;
+#else
+		const char* res_begin_ptr;
+		const std::size_t* res_size_ptr;	// the size lives in the generated object
+#endif
+		unsigned res_id;
+
+		friend detail::ResourceAccess;
+
+		// Data access, counted by the profiler; in dev mode it may remap a changed file
+		detail::DataView use() const noexcept {
+			detail::on_access(res_id);
+#if defined(RESMAN_DEV_MODE)
+			return detail::DevResourceMap::instance().view(*res_info, true);
+#elif defined(RESMAN_BLOB_LAYOUT)
+			return detail::blob_view(res_id);
+#elif defined(RESMAN_DEDUP_CONTENT)
+			return *res_view;
+#else
+			return { res_begin_ptr, *res_size_ptr };
+#endif
+		}
+
+		detail::DataView peek() const noexcept {
+#if defined(RESMAN_DEV_MODE)
+			return detail::DevResourceMap::instance().view(*res_info, false);
+#elif defined(RESMAN_BLOB_LAYOUT)
+			return detail::blob_view(res_id);
+#elif defined(RESMAN_DEDUP_CONTENT)
+			return *res_view;
+#else
+			return { res_begin_ptr, *res_size_ptr };
+#endif
+		}
 
 	public:
 		template <unsigned N>
-		ResourceHandle(Resource<N>)
+		constexpr ResourceHandle(Resource<N>) noexcept
+#if defined(RESMAN_DEV_MODE)
+			: res_info(&Resource<N>::storage_info)
+			, res_id(N)
+#elif defined(RESMAN_BLOB_LAYOUT)
 			: res_id(N)
-			, res_byte_size(Resource<N>::storage_size)
-			, res_begin_ptr(Resource<N>::storage_begin)
-			, res_end_ptr(res_begin_ptr + res_byte_size)
+#elif defined(RESMAN_DEDUP_CONTENT)
+			: res_view(&Resource<N>::storage_view)
+			, res_id(N)
+#else
+			: res_begin_ptr(Resource<N>::storage_begin)
+			, res_size_ptr(&Resource<N>::storage_size)
+			, res_id(N)
+#endif
 		{}
 
-		const char* begin() {
-			return res_begin_ptr;
+		// Each of these reads the data separately. In dev mode the file may be
+		// reloaded between two calls, so a begin()/end() or data()/size() pair
+		// can mix two mappings; view(), bytes(), chunks() and forEachChunk()
+		// read it once.
+		const char* begin() const noexcept {
+			return use().data;
+		}
+		const char* end() const noexcept {
+			const detail::DataView v = peek();
+			return v.data + v.size;
 		}
-		const char* end() {
-			return res_end_ptr;
+		const char* data() const noexcept {
+			return use().data;
 		}
-		unsigned size() {
-			return res_byte_size;
+		std::size_t size() const noexcept {
+#if defined(RESMAN_BLOB_LAYOUT) && !defined(RESMAN_DEV_MODE)
+			return detail::blob_size(res_id);
+#else
+			return peek().size;
+#endif
 		}
-		unsigned id() {
+		bool empty() const noexcept {
+			return size() == 0;
+		}
+		constexpr unsigned id() const noexcept {
 			return res_id;
 		}
+
+		// Calls fn(const char* data, std::size_t size) for consecutive pieces of
+		// at most chunkSize bytes (chunkSize must not be 0)
+		template <typename F>
+		void forEachChunk(std::size_t chunkSize, F&& fn) const {
+			const detail::DataView v = use();
+			for (std::size_t offset = 0; offset < v.size; offset += chunkSize)
+				fn(v.data + offset, v.size - offset < chunkSize ? v.size - offset : chunkSize);
+		}
+
+		// The resource parsed into a T (std::shared_ptr<const T>), once per process,
+		// by the decoder registered for T; needs resman_decode.h
+		template <typename T>
+		typename detail::DecodeResult<T>::type as() const;
+
+		// Scatter-gather access: calls fn(const char* data, std::size_t size) for
+		// the pieces the resource is stored in, in order, without copying. Only
+		// resources stored with --chunk-dedup have more than one piece.
+		template <typename F>
+		void forEachSegment(F&& fn) const {
+#if defined(RESMAN_BLOB_LAYOUT) && !defined(RESMAN_DEV_MODE)
+			if (detail::blob_segments(res_id, fn)) {
+				detail::on_access(res_id);
+				return;
+			}
+#endif
+			const detail::DataView v = use();
+			if (v.size)
+				fn(v.data, v.size);
+		}
+
+#if defined(RESMAN_HAS_STRING_VIEW)
+		std::string_view view() const noexcept {
+			const detail::DataView v = use();
+			return { v.data, v.size };
+		}
+		explicit operator std::string_view() const noexcept {
+			return view();
+		}
+
+		// Range of string_view pieces of at most chunkSize bytes (not 0):
+		//   for (std::string_view chunk : res.chunks(64 * 1024)) ...
+		class ChunkRange {
+		public:
+			class iterator {
+			public:
+				using value_type = std::string_view;
+				using difference_type = std::ptrdiff_t;
+				using pointer = const std::string_view*;
+				using reference = std::string_view;
+				using iterator_category = std::input_iterator_tag;
+
+				constexpr iterator(std::string_view rest, std::size_t chunkSize) noexcept
+					: m_rest(rest), m_chunk_size(chunkSize) {}
+
+				std::string_view operator*() const noexcept {
+					return m_rest.substr(0, m_chunk_size);
+				}
+				iterator& operator++() noexcept {
+					m_rest.remove_prefix(m_rest.size() < m_chunk_size ? m_rest.size() : m_chunk_size);
+					return *this;
+				}
+				iterator operator++(int) noexcept {
+					iterator prev = *this;
+					++*this;
+					return prev;
+				}
+				friend bool operator==(const iterator& a, const iterator& b) noexcept {
+					return a.m_rest.size() == b.m_rest.size();	// same range, so the same remainder
+				}
+				friend bool operator!=(const iterator& a, const iterator& b) noexcept {
+					return !(a == b);
+				}
+
+			private:
+				std::string_view m_rest;
+				std::size_t m_chunk_size;
+			};
+
+			constexpr ChunkRange(std::string_view data, std::size_t chunkSize) noexcept
+				: m_data(data), m_chunk_size(chunkSize) {}
+
+			iterator begin() const noexcept {
+				return { m_data, m_chunk_size };
+			}
+			iterator end() const noexcept {
+				return { m_data.substr(m_data.size()), m_chunk_size };
+			}
+
+		private:
+			std::string_view m_data;
+			std::size_t m_chunk_size;
+		};
+
+		ChunkRange chunks(std::size_t chunkSize) const noexcept {
+			return { view(), chunkSize };
+		}
+#endif
+
+#if defined(__cpp_lib_span)
+		std::span<const std::byte> bytes() const noexcept {
+			const detail::DataView v = use();
+			return { reinterpret_cast<const std::byte*>(v.data), v.size };
+		}
+		explicit operator std::span<const std::byte>() const noexcept {
+			return bytes();
+		}
+#endif
 	};
-}
\ No newline at end of file
+
+	namespace detail {
+		struct ResourceAccess {
+			// Data and size from a single read, for the runtime headers
+			static DataView view(ResourceHandle res) noexcept {
+				return res.use();
+			}
+
+#if defined(RESMAN_DEV_MODE) || defined(RESMAN_BLOB_LAYOUT)
+#elif defined(RESMAN_DEDUP_CONTENT)
+			template <unsigned N>
+			static const char* begin() {
+				return Resource<N>::storage_view.data;
+			}
+#else
+			template <unsigned N>
+			static constexpr const char* begin() {
+				return Resource<N>::storage_begin;
+			}
+#endif
+		};
+
+		// Resources of one generated object (built with --resource-registry).
+		// Every such object links its node into a list during static initialization.
+		struct RegistryEntry {
+			unsigned id;
+			const char* begin;
+			std::size_t size;
+		};
+
+		struct RegistryNode {
+			const RegistryEntry* entries;
+			std::size_t count;
+			RegistryNode* next;
+		};
+
+		inline RegistryNode*& registry_head() {
+			static RegistryNode* head = nullptr;
+			return head;
+		}
+
+		struct Registrar {
+			explicit Registrar(RegistryNode& node) {
+				node.next = registry_head();
+				registry_head() = &node;
+			}
+		};
+	}
+
+	// Calls fn(const detail::RegistryEntry&) for every registered resource
+	template <typename F>
+	void forEachResource(F&& fn) {
+		for (const detail::RegistryNode* node = detail::registry_head(); node; node = node->next)
+			for (std::size_t i = 0; i < node->count; ++i)
+				fn(node->entries[i]);
+
+#if defined(RESMAN_BLOB_LAYOUT) && !defined(RESMAN_DEV_MODE)
+		// blob objects need no registry: their indexes are in the link-time table
+		// (chunk-deduplicated resources are assembled)
+		for (const detail::BlobIndex* const* slot = detail::blob_table_begin(); slot != detail::blob_table_end(); ++slot) {
+			if (!*slot)
+				continue;
+			for (std::size_t i = 0; i < (*slot)->count; ++i) {
+				const detail::DataView v = detail::blob_entry_view(**slot, i);
+				const detail::RegistryEntry entry = { detail::blob_entry_id(**slot, i), v.data, v.size };
+				fn(entry);
+			}
+		}
+#endif
+	}
+
+#if defined(RESMAN_PROFILE)
+	// Writes the access profile recorded so far; it is written again at exit
+	inline bool writeAccessProfile(const char* path) {
+		return detail::AccessProfile::instance().write(path);
+	}
+#endif
+}
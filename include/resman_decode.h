@@ -0,0 +1,290 @@
+#pragma once
+
+// Decoded resources: res.as<T>() parses a resource into a T with the decoder
+// registered for T, once per process, and hands the same immutable object to
+// every caller and thread.
+//
+//   resman::registerDecoder<Config>([](const char* data, std::size_t size) { return parseConfig(data, size); });
+//   std::shared_ptr<const Config> config = resman::ResourceHandle(configResource).as<Config>();
+//
+// Once a resource is decoded, as<T>() takes no lock. Types constructible from
+// (const char*, std::size_t), like std::string, need no decoder. Concurrent
+// first calls for one resource decode it once; the others wait for it. If the
+// decoder throws, the exception propagates and the next call tries again.
+//
+// setDecodeBudget<T>() bounds the resources kept decoded per type by their
+// embedded size; beyond it, the least recently used (approximately) are
+// dropped and decoded again on their next use. Objects already handed out
+// stay valid. In dev mode, a resource changed on disk is decoded again.
+
+#include "resman.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace resman {
+	namespace detail {
+		template <typename T>
+		struct DecodeResult {
+			using type = std::shared_ptr<const T>;
+		};
+
+		template <typename T>
+		typename std::enable_if<std::is_constructible<T, const char*, std::size_t>::value, T>::type
+		default_decode(const char* data, std::size_t size) {
+			return T(data, size);
+		}
+
+		template <typename T>
+		typename std::enable_if<!std::is_constructible<T, const char*, std::size_t>::value, T>::type
+		default_decode(const char*, std::size_t) {
+			throw std::logic_error("resman: no decoder registered for this type (resman::registerDecoder)");
+		}
+
+		// Decoded objects of one type, by resource id. A slot is created once per
+		// id and never removed, so lookups walk immutable bucket chains. Readers
+		// announce themselves in the slot while copying its value, which an
+		// eviction waits out before freeing it.
+		template <typename T>
+		class DecodeCache {
+		public:
+			using Decoder = std::function<T(const char*, std::size_t)>;
+
+			static DecodeCache& instance() {
+				static DecodeCache cache;
+				return cache;
+			}
+
+			std::shared_ptr<const T> get(ResourceHandle res) {
+				Slot& slot = find_slot(res.id());
+#if defined(RESMAN_DEV_MODE)
+				// the decode must be of the file as it is now
+				const char* source = ResourceAccess::view(res).data;
+#else
+				// not read at all: that would count as an access, and assemble
+				// or look up blob resources
+				const char* source = nullptr;
+#endif
+				std::shared_ptr<const T> object = acquire(slot, source);
+				if (object)
+					return object;
+				return decode(slot, res);
+			}
+
+			void set_decoder(Decoder decoder) {
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_decoder = std::move(decoder);
+				evict_all();
+			}
+
+			void set_budget(std::size_t bytes) {
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_budget = bytes;
+				evict_over_budget(nullptr);
+			}
+
+			void clear() {
+				std::lock_guard<std::mutex> lock(m_mutex);
+				evict_all();
+			}
+
+			~DecodeCache() {
+				for (std::atomic<Slot*>& bucket : m_buckets) {
+					Slot* slot = bucket.load();
+					while (slot) {
+						Slot* next = slot->next;
+						delete slot->value.load();
+						delete slot;
+						slot = next;
+					}
+				}
+			}
+
+		private:
+			struct Value {
+				std::shared_ptr<const T> object;
+				const char* source;		// data decoded (dev mode: to notice a reload)
+				std::size_t cost;		// embedded size, counted against the budget
+			};
+
+			struct Slot {
+				Slot(unsigned slotId, Slot* nextSlot) : id(slotId), next(nextSlot) {}
+
+				const unsigned id;
+				Slot* const next;
+				std::atomic<Value*> value{ nullptr };
+				std::atomic<unsigned> readers{ 0 };
+				std::atomic<bool> referenced{ false };	// used since the eviction hand passed
+				std::mutex decoding;
+			};
+
+			static constexpr std::size_t kBuckets = 256;
+
+			DecodeCache() {
+				for (std::atomic<Slot*>& bucket : m_buckets)
+					bucket.store(nullptr);
+			}
+
+			static const char* source_of(const DataView& view) {
+#if defined(RESMAN_DEV_MODE)
+				return view.data;
+#else
+				(void)view;
+				return nullptr;	// embedded data never changes
+#endif
+			}
+
+			Slot& find_slot(unsigned id) {
+				std::atomic<Slot*>& bucket = m_buckets[id % kBuckets];
+				for (Slot* slot = bucket.load(std::memory_order_acquire); slot; slot = slot->next)
+					if (slot->id == id)
+						return *slot;
+
+				std::lock_guard<std::mutex> lock(m_mutex);
+				for (Slot* slot = bucket.load(std::memory_order_relaxed); slot; slot = slot->next)
+					if (slot->id == id)
+						return *slot;
+
+				Slot* slot = new Slot(id, bucket.load(std::memory_order_relaxed));
+				bucket.store(slot, std::memory_order_release);
+				return *slot;
+			}
+
+			// The fast path: no lock, a copy of the shared_ptr if decoded
+			static std::shared_ptr<const T> acquire(Slot& slot, const char* source) {
+				std::shared_ptr<const T> object;
+				slot.readers.fetch_add(1);
+				const Value* value = slot.value.load();
+				if (value && value->source == source)
+					object = value->object;
+				slot.readers.fetch_sub(1);
+
+				if (object && !slot.referenced.load(std::memory_order_relaxed))
+					slot.referenced.store(true, std::memory_order_relaxed);
+				return object;
+			}
+
+			std::shared_ptr<const T> decode(Slot& slot, ResourceHandle res) {
+				std::lock_guard<std::mutex> decoding(slot.decoding);
+
+				// one read: in dev mode the file may be reloaded meanwhile
+				const DataView view = ResourceAccess::view(res);
+				const char* data = view.data;
+				const std::size_t size = view.size;
+				const char* source = source_of(view);
+
+				// decoded by another thread while this one waited
+				std::shared_ptr<const T> object = acquire(slot, source);
+				if (object)
+					return object;
+
+				Decoder decoder;
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					decoder = m_decoder;
+				}
+
+				object = std::make_shared<T>(decoder ? decoder(data, size) : default_decode<T>(data, size));
+				publish(slot, new Value{ object, source, size });
+				return object;
+			}
+
+			void publish(Slot& slot, Value* value) {
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_resident_bytes += value->cost;
+				slot.referenced.store(true, std::memory_order_relaxed);
+
+				// dev mode: replaces the decode of the previous file contents
+				Value* previous = slot.value.exchange(value);
+				if (previous)
+					retire(slot, previous);
+				else
+					m_resident.push_back(&slot);
+
+				evict_over_budget(&slot);
+			}
+
+			// Caller holds m_mutex and has unpublished the value
+			void retire(Slot& slot, Value* value) {
+				while (slot.readers.load() != 0)
+					std::this_thread::yield();
+				m_resident_bytes -= value->cost;
+				delete value;
+			}
+
+			void evict(std::size_t index) {
+				Slot& slot = *m_resident[index];
+				m_resident.erase(m_resident.begin() + static_cast<std::ptrdiff_t>(index));
+				if (Value* value = slot.value.exchange(nullptr))
+					retire(slot, value);
+			}
+
+			void evict_all() {
+				while (!m_resident.empty())
+					evict(m_resident.size() - 1);
+				m_hand = 0;
+			}
+
+			// Second-chance (CLOCK): resources used since the hand last passed
+			// them are skipped once. keep is the resource just decoded.
+			void evict_over_budget(const Slot* keep) {
+				if (m_budget == 0)
+					return;
+
+				while (m_resident_bytes > m_budget && !m_resident.empty()) {
+					if (m_resident.size() == 1 && m_resident.front() == keep)
+						break;
+					if (m_hand >= m_resident.size())
+						m_hand = 0;
+
+					Slot* slot = m_resident[m_hand];
+					if (slot != keep && !slot->referenced.exchange(false, std::memory_order_relaxed))
+						evict(m_hand);
+					else
+						++m_hand;
+				}
+			}
+
+		private:
+			std::atomic<Slot*> m_buckets[kBuckets];
+
+			std::mutex m_mutex;				// slot creation, decoder, budget, resident list
+			Decoder m_decoder;
+			std::size_t m_budget = 0;		// 0: unlimited
+			std::size_t m_resident_bytes = 0;
+			std::vector<Slot*> m_resident;	// decoded slots, in eviction-hand order
+			std::size_t m_hand = 0;
+		};
+	}
+
+	// Decoder for T, used by every later as<T>(). Decoded objects of T from an
+	// earlier decoder are dropped.
+	template <typename T, typename F>
+	void registerDecoder(F&& decoder) {
+		detail::DecodeCache<T>::instance().set_decoder(std::forward<F>(decoder));
+	}
+
+	// Keeps decoded Ts of at most this many embedded bytes (0: all, the default)
+	template <typename T>
+	void setDecodeBudget(std::size_t bytes) {
+		detail::DecodeCache<T>::instance().set_budget(bytes);
+	}
+
+	// Drops every decoded T; handed out objects stay valid
+	template <typename T>
+	void clearDecoded() {
+		detail::DecodeCache<T>::instance().clear();
+	}
+
+	template <typename T>
+	typename detail::DecodeResult<T>::type ResourceHandle::as() const {
+		return detail::DecodeCache<T>::instance().get(*this);
+	}
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+// Dev-mode runtime, included by resman.h when RESMAN_DEV_MODE is defined.
+//
+// Sources generated with resman-lite --dev-mode embed only each resource's
+// absolute path; the file is mapped on first access and remapped when its
+// size or modification time changes (checked at most every 100 ms per
+// resource). Earlier mappings stay valid for the lifetime of the process, so
+// pointers obtained before a reload keep showing the old contents. Tools that
+// truncate and rewrite a file in place (instead of replacing it) can still
+// change pages under an old mapping; never ship dev-mode builds.
+
+#if !(__cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L))
+#error "resman-lite: RESMAN_DEV_MODE needs C++17"
+#endif
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <mutex>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace resman {
+	namespace detail {
+		struct DevResourceInfo {
+			const char* path;		// absolute path resolved at build time
+			std::size_t size_hint;	// file size at build time
+		};
+
+		class DevResourceMap {
+		public:
+			static DevResourceMap& instance() {
+				static DevResourceMap map;
+				return map;
+			}
+
+			// Current contents; with refresh, remapped first if the file changed
+			DataView view(const DevResourceInfo& info, bool refresh) noexcept {
+				try {
+					std::lock_guard<std::mutex> lock(m_mutex);
+					Entry& entry = m_entries[&info];
+
+					const auto now = std::chrono::steady_clock::now();
+					const bool due = now - entry.last_check >= std::chrono::milliseconds(100);
+					if (!entry.mapped || (refresh && due)) {
+						entry.last_check = now;
+						reload(info, entry);
+					}
+					return entry.view;
+				}
+				catch (...) {
+					return { "", 0 };
+				}
+			}
+
+		private:
+			struct Entry {
+				DataView view{ "", 0 };
+				bool mapped = false;
+				std::filesystem::file_time_type mtime{};
+				std::uintmax_t size = 0;
+				std::chrono::steady_clock::time_point last_check{};
+			};
+
+			DevResourceMap() = default;
+
+			void reload(const DevResourceInfo& info, Entry& entry) {
+				std::error_code ec;
+				const auto mtime = std::filesystem::last_write_time(info.path, ec);
+				const auto size = ec ? 0 : std::filesystem::file_size(info.path, ec);
+				if (ec) {
+					if (!entry.mapped)
+						std::fprintf(stderr, "resman: cannot read %s\n", info.path);
+					entry.mapped = true;	// keep serving the last contents
+					return;
+				}
+
+				if (entry.mapped && entry.mtime == mtime && entry.size == size)
+					return;
+
+				entry.view = map(info.path, static_cast<std::size_t>(size));
+				entry.mtime = mtime;
+				entry.size = size;
+				entry.mapped = true;
+			}
+
+			// Read-only mapping of the whole file; never unmapped
+			static DataView map(const char* path, std::size_t size) {
+				if (size == 0)
+					return { "", 0 };
+#if defined(_WIN32)
+				HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+					nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+				if (file == INVALID_HANDLE_VALUE)
+					return { "", 0 };
+				HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				CloseHandle(file);
+				if (!mapping)
+					return { "", 0 };
+				const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+				CloseHandle(mapping);
+#else
+				const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+				if (fd < 0)
+					return { "", 0 };
+				void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+				::close(fd);
+				if (data == MAP_FAILED)
+					data = nullptr;
+#endif
+				if (!data)
+					return { "", 0 };
+				return { static_cast<const char*>(data), size };
+			}
+
+			std::mutex m_mutex;
+			std::map<const DevResourceInfo*, Entry> m_entries;
+		};
+	}
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+// Startup warm-up for embedded resources: advise the OS to read them in,
+// fault them in from a background thread, or pin critical ones in memory.
+// prefetchAll() covers the resources of objects built with --resource-registry.
+
+#include "resman.h"
+
+#include <cstdint>
+#include <future>
+#include <initializer_list>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace resman {
+	struct PrefetchOptions {
+		bool touch = false;	// read one byte per page, so the pages are resident on return
+		bool lock = false;	// mlock / VirtualLock; subject to RLIMIT_MEMLOCK / working set limits
+	};
+
+	// Page-aligned range covering a resource
+	struct PageExtent {
+		const char* begin;
+		std::size_t length;
+	};
+
+	inline std::size_t pageSize() {
+#if defined(_WIN32)
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		return static_cast<std::size_t>(info.dwPageSize);
+#else
+		return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+	}
+
+	inline PageExtent pageExtent(const char* begin, std::size_t size) {
+		const std::uintptr_t page = pageSize();
+		const std::uintptr_t first = reinterpret_cast<std::uintptr_t>(begin) & ~(page - 1);
+		const std::uintptr_t last = (reinterpret_cast<std::uintptr_t>(begin) + size + page - 1) & ~(page - 1);
+		return { reinterpret_cast<const char*>(first), static_cast<std::size_t>(last - first) };
+	}
+
+	namespace detail {
+		inline bool prefetchRange(const char* begin, std::size_t size, const PrefetchOptions& opts) {
+			if (size == 0)
+				return true;
+
+			const PageExtent extent = pageExtent(begin, size);
+			bool ok = true;
+#if defined(_WIN32)
+			WIN32_MEMORY_RANGE_ENTRY range{ const_cast<char*>(extent.begin), extent.length };
+			ok = PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0) != 0;
+			if (opts.lock)
+				ok = VirtualLock(const_cast<char*>(extent.begin), extent.length) != 0 && ok;
+#else
+			ok = madvise(const_cast<char*>(extent.begin), extent.length, MADV_WILLNEED) == 0;
+			if (opts.lock)
+				ok = mlock(extent.begin, extent.length) == 0 && ok;
+#endif
+			if (opts.touch) {
+				const std::size_t page = pageSize();
+				volatile char sink = 0;
+				for (std::size_t offset = 0; offset < size; offset += page)
+					sink = sink + begin[offset];
+				sink = sink + begin[size - 1];
+			}
+			return ok;
+		}
+	}
+
+	inline bool prefetch(ResourceHandle res, const PrefetchOptions& opts = {}) {
+		const detail::DataView view = detail::ResourceAccess::view(res);
+		return detail::prefetchRange(view.data, view.size, opts);
+	}
+
+	inline bool prefetch(std::initializer_list<ResourceHandle> resources, const PrefetchOptions& opts = {}) {
+		bool ok = true;
+		for (ResourceHandle res : resources)
+			ok = prefetch(res, opts) && ok;
+		return ok;
+	}
+
+	inline bool prefetch(const std::vector<ResourceHandle>& resources, const PrefetchOptions& opts = {}) {
+		bool ok = true;
+		for (ResourceHandle res : resources)
+			ok = prefetch(res, opts) && ok;
+		return ok;
+	}
+
+	inline bool prefetchAll(const PrefetchOptions& opts = {}) {
+		bool ok = true;
+		forEachResource([&](const detail::RegistryEntry& entry) {
+			ok = detail::prefetchRange(entry.begin, entry.size, opts) && ok;
+		});
+		return ok;
+	}
+
+	// prefetchAll() on a background thread, touching pages unless told otherwise.
+	// The registry is complete once static initialization is done, so call this from main().
+	inline std::future<bool> prefetchAllAsync(PrefetchOptions opts = { true, false }) {
+		return std::async(std::launch::async, [opts] { return prefetchAll(opts); });
+	}
+
+	// Keeps a resource's pages resident until unlock()
+	inline bool lock(ResourceHandle res) {
+		const detail::DataView view = detail::ResourceAccess::view(res);
+		return detail::prefetchRange(view.data, view.size, { false, true });
+	}
+
+	inline bool unlock(ResourceHandle res) {
+		const detail::DataView view = detail::ResourceAccess::view(res);
+		if (view.size == 0)
+			return true;
+
+		const PageExtent extent = pageExtent(view.data, view.size);
+#if defined(_WIN32)
+		return VirtualUnlock(const_cast<char*>(extent.begin), extent.length) != 0;
+#else
+		return munlock(extent.begin, extent.length) == 0;
+#endif
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+// Read-only std::streambuf / std::istream over an embedded resource, for
+// parsers that want a stream. Reads straight from the embedded bytes; nothing
+// is copied.
+//
+//   resman::ResourceStream in(resman::ResourceHandle(myResource));
+//   parse(in);
+
+#include "resman.h"
+
+#include <istream>
+#include <streambuf>
+
+namespace resman {
+	class ResourceStreamBuf : public std::streambuf {
+	public:
+		ResourceStreamBuf(const char* data, std::size_t size) {
+			// the get area is never written to: putback of a different character fails
+			char* begin = const_cast<char*>(data);
+			setg(begin, begin, begin + size);
+		}
+
+		explicit ResourceStreamBuf(ResourceHandle res)
+			: ResourceStreamBuf(detail::ResourceAccess::view(res)) {}
+
+	private:
+		explicit ResourceStreamBuf(detail::DataView view)
+			: ResourceStreamBuf(view.data, view.size) {}
+
+	protected:
+		std::streamsize showmanyc() override {
+			return egptr() - gptr();
+		}
+
+		pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override {
+			if (!(which & std::ios_base::in))
+				return pos_type(off_type(-1));
+
+			off_type base = 0;
+			if (dir == std::ios_base::cur)
+				base = gptr() - eback();
+			else if (dir == std::ios_base::end)
+				base = egptr() - eback();
+
+			const off_type target = base + off;
+			if (target < 0 || target > egptr() - eback())
+				return pos_type(off_type(-1));
+
+			setg(eback(), eback() + target, egptr());
+			return pos_type(target);
+		}
+
+		pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+			return seekoff(off_type(pos), std::ios_base::beg, which);
+		}
+	};
+
+	class ResourceStream : public std::istream {
+	public:
+		ResourceStream(const char* data, std::size_t size)
+			: std::istream(nullptr), m_buf(data, size) {
+			rdbuf(&m_buf);
+		}
+
+		explicit ResourceStream(ResourceHandle res)
+			: ResourceStream(detail::ResourceAccess::view(res)) {}
+
+	private:
+		explicit ResourceStream(detail::DataView view)
+			: ResourceStream(view.data, view.size) {}
+
+		ResourceStreamBuf m_buf;
+	};
+}
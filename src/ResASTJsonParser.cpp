@@ -1,5 +1,4 @@
 #include "ResASTJsonParser.h"
-#include <iostream>
 #include <fstream>
 #include <filesystem>
 
@@ -14,21 +13,36 @@ namespace resman
         return *this;
     }
 
+    ResASTJsonParser& ResASTJsonParser::setInputJsonText(const std::string& jsonText)
+    {
+        mInputJsonText = jsonText;
+        return *this;
+    }
+
     ResASTJsonParser& ResASTJsonParser::setOutputJson(const std::string& path)
     {
         mOutputJson = path;
         return *this;
     }
 
+    ResASTJsonParser& ResASTJsonParser::setLogCallback(LogCallback callback)
+    {
+        mLog.setCallback(std::move(callback));
+        return *this;
+    }
+
     bool ResASTJsonParser::validateInputs() const
     {
+        if (mInputJsonText.has_value())
+            return true;
+
         if (mInputJson.empty()) {
-            std::cerr << "[ResASTJsonParser] Error: input JSON path not set.\n";
+            mLog.error() << "Error: input JSON path not set.";
             return false;
         }
 
         if (!fs::exists(mInputJson)) {
-            std::cerr << "[ResASTJsonParser] Error: input JSON does not exist: " << mInputJson << "\n";
+            mLog.error() << "Error: input JSON does not exist: " << mInputJson;
             return false;
         }
 
@@ -37,18 +51,24 @@ namespace resman
 
     bool ResASTJsonParser::parseASTJson()
     {
-        std::ifstream in(mInputJson);
-        if (!in) {
-            std::cerr << "[ResASTJsonParser] Error: failed to open " << mInputJson << "\n";
-            return false;
-        }
+        mResources.clear();
 
         json ast;
         try {
-            in >> ast;
+            if (mInputJsonText.has_value()) {
+                ast = json::parse(*mInputJsonText);
+            }
+            else {
+                std::ifstream in(mInputJson);
+                if (!in) {
+                    mLog.error() << "Error: failed to open " << mInputJson;
+                    return false;
+                }
+                in >> ast;
+            }
         }
         catch (const std::exception& e) {
-            std::cerr << "[ResASTJsonParser] JSON parse error: " << e.what() << "\n";
+            mLog.error() << "JSON parse error: " << e.what();
             return false;
         }
 
@@ -130,16 +150,9 @@ namespace resman
         if (!mOutputJson.empty()) {
             std::ofstream out(mOutputJson);
             if (out) {
-                json outData = json::array();
-                for (const auto& r : mResources) {
-                    outData.push_back({
-                        {"type", r.resType},
-                        {"name", r.resName},
-                        {"path", r.resFilepath}
-                    });
-                }
+                json outData = mResources;
                 out << outData.dump(4);
-                std::cout << "[ResASTJsonParser] Extracted info written to " << mOutputJson << "\n";
+                mLog.info() << "Extracted info written to " << mOutputJson;
             }
         }
 
@@ -149,11 +162,11 @@ namespace resman
 
     void ResASTJsonParser::printSummary() const
     {
-        std::cout << "\n=== Resource Summary ===\n";
+        mLog.info() << "=== Resource Summary ===";
         for (const auto& r : mResources) {
-            std::cout << "Res: " << r.resType
-                    << ", Var: " << r.resName
-                    << ", Path: " << r.resFilepath << "\n";
+            mLog.info() << "Res: " << r.resType
+                        << ", Var: " << r.resName
+                        << ", Path: " << r.resFilepath;
         }
     }
 
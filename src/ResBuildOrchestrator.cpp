@@ -1,8 +1,16 @@
 #include "ResBuildOrchestrator.h"
+#include "ResHash.h"
+#include "ResJobServer.h"
+#include "ResTaskGraph.h"
 
 #include <filesystem>
-#include <iostream>
 #include <cstdlib>
+#include <fstream>
+#include <random>
+#include <future>
+#include <set>
+#include <algorithm>
+#include <cctype>
 
 namespace fs = std::filesystem;
 
@@ -14,6 +22,30 @@ namespace resman
         return *this;
     }
 
+    ResBuildOrchestrator& ResBuildOrchestrator::setLogCallback(LogCallback callback)
+    {
+        mLog.setCallback(std::move(callback));
+        return *this;
+    }
+
+    ResBuildOrchestrator& ResBuildOrchestrator::setResourceInfo(const std::vector<ResourceInfo>& resInfo)
+    {
+        mResInfo = resInfo;
+        return *this;
+    }
+
+    ResBuildOrchestrator& ResBuildOrchestrator::setHeaderSource(const std::string& source)
+    {
+        mHeaderSource = source;
+        return *this;
+    }
+
+    ResBuildOrchestrator& ResBuildOrchestrator::addResourceData(const std::string& resFilepath, std::string data)
+    {
+        mResData[resFilepath] = std::move(data);
+        return *this;
+    }
+
     bool ResBuildOrchestrator::prepareWorkingDir()
     {
         if (mOpts.workingDir.has_value() && !mOpts.workingDir->empty())
@@ -25,81 +57,444 @@ namespace resman
         }
         else
         {
-            // create a temp working dir
-            auto tempBase = fs::temp_directory_path() / "resman-lite-temp";
+            // create a temp working dir, unique so concurrent invocations don't collide
+            std::random_device rd;
+            auto tempBase = fs::temp_directory_path() / ("resman-lite-temp-" + std::to_string(rd()));
             fs::create_directories(tempBase);
             mActiveWorkingDir = tempBase.string();
             mIsTempWorkingDir = true;
         }
-        std::cout << "[ResBuildOrchestrator] Using working dir: " << mActiveWorkingDir << "\n";
+        mLog.info() << "Using working dir: " << mActiveWorkingDir;
         return true;
     }
 
     void ResBuildOrchestrator::cleanupWorkingDir()
     {
+        if (mActiveWorkingDir.empty())
+            return;
+
         if (mIsTempWorkingDir)
         {
             try
             {
                 fs::remove_all(mActiveWorkingDir);
-                std::cout << "[ResBuildOrchestrator] Cleaned temporary working dir: " << mActiveWorkingDir << "\n";
+                mLog.info() << "Cleaned temporary working dir: " << mActiveWorkingDir;
             }
             catch (const std::exception& e)
             {
-                std::cerr << "[ResBuildOrchestrator] Warning: Failed to delete temp dir: " << e.what() << "\n";
+                mLog.warning() << "Warning: Failed to delete temp dir: " << e.what();
             }
         }
         else
         {
-            std::cout << "[ResBuildOrchestrator] Keeping user-provided working dir: " << mActiveWorkingDir << "\n";
+            mLog.info() << "Keeping user-provided working dir: " << mActiveWorkingDir;
         }
+        mActiveWorkingDir.clear();
     }
 
-    bool ResBuildOrchestrator::run()
+    // clang needs a file; content-addressed so the header cache still hits
+    // when the same source is passed again
+    bool ResBuildOrchestrator::materializeHeaderSource()
     {
-        if (mOpts.resHeader.empty() || mOpts.outputObj.empty())
+        mHeaderPaths.clear();
+        if (!mHeaderSource.has_value())
         {
-            std::cerr << "[ResBuildOrchestrator] Missing mandatory options (--res-header, --obj-name)\n";
-            return false;
+            if (!mOpts.resHeader.empty())
+                mHeaderPaths.push_back(mOpts.resHeader);
+            mHeaderPaths.insert(mHeaderPaths.end(), mOpts.resHeaders.begin(), mOpts.resHeaders.end());
+            return true;
         }
 
-        prepareWorkingDir();
+        fs::path dir = fs::temp_directory_path() / "resman-lite-headers";
+        fs::path path = dir / (ResHasher::hashString(*mHeaderSource) + ".h");
+
+        std::error_code ec;
+        fs::create_directories(dir, ec);
+        if (!fs::exists(path))
+        {
+            fs::path tmpPath = path.string() + ".tmp" + std::to_string(std::random_device{}());
+            std::ofstream(tmpPath, std::ios::binary) << *mHeaderSource;
+            fs::rename(tmpPath, path, ec);
+            if (ec)
+            {
+                fs::remove(tmpPath, ec);
+                if (!fs::exists(path))
+                {
+                    mLog.error() << "Error: failed to write header source to " << path.string();
+                    return false;
+                }
+            }
+        }
+
+        mHeaderPaths.push_back(path.string());
+        mHeaderPaths.insert(mHeaderPaths.end(), mOpts.resHeaders.begin(), mOpts.resHeaders.end());
+        return true;
+    }
+
+    std::string ResBuildOrchestrator::resolveCacheDir() const
+    {
+        if (mOpts.cacheDir.has_value() && !mOpts.cacheDir->empty())
+            return *mOpts.cacheDir;
+
+        if (const char* env = std::getenv("RESMAN_LITE_CACHE_DIR"); env && *env)
+            return env;
+
+        return (fs::temp_directory_path() / "resman-lite-cache").string();
+    }
+
+    bool ResBuildOrchestrator::objectCacheEnabled() const
+    {
+        // a verification build restored from the cache would prove nothing
+        if (!mOpts.useCache || mVerifying)
+            return false;
+
+        if (mOpts.useObjectCache)
+            return true;
+
+        const char* env = std::getenv("RESMAN_LITE_OBJECT_CACHE");
+        return env && *env && std::string(env) != "0";
+    }
+
+    bool ResBuildOrchestrator::parseResourceHeader(const std::string& header, size_t index,
+                                                   std::vector<ResourceInfo>& resources,
+                                                   std::vector<std::string>& dependencies) const
+    {
+        // every header has its own cache entry, so editing one doesn't reparse the others
+        resman::ResHeaderCache cache;
+        if (mOpts.useCache)
+        {
+            cache.setLogCallback(mLog.getCallback())
+                 .setCacheDir(resolveCacheDir())
+                 .setWorkingDir(mActiveWorkingDir)
+                 .setHeaderFile(header)
+                 .addIncludePath(mOpts.includePaths)
+                 .setClangPath(mOpts.clangPath);
+
+            if (cache.lookup(resources))
+            {
+                dependencies = cache.getDependencies();
+                return true;
+            }
+        }
 
         // Parse header to get includes
         resman::ResHeaderParser headerParser;
-        std::string jsonPath = mActiveWorkingDir + "/ast.json";
+        std::string suffix = index ? "." + std::to_string(index) : "";
+        std::string jsonPath = mActiveWorkingDir + "/ast" + suffix + ".json";
+        std::string depPath = mActiveWorkingDir + "/ast" + suffix + ".d";
 
-        headerParser.setHeaderFile(mOpts.resHeader)
+        headerParser.setLogCallback(mLog.getCallback())
+                    .setHeaderFile(header)
                     .setOutputJson(jsonPath)
+                    .setDepFile(depPath)
                     .addIncludePath(mOpts.includePaths)
-                    .setClangPath(mOpts.clangPath);         
+                    .setClangPath(mOpts.clangPath);
 
-        if (!headerParser.run())
-            return false;
+        {
+            auto token = ResJobServer::instance().acquire();
+            if (!headerParser.run())
+                return false;
+        }
 
         // Parse AST JSON
         resman::ResASTJsonParser astParser;
 
-        astParser.setInputJson(jsonPath);
+        astParser.setLogCallback(mLog.getCallback())
+                 .setInputJson(jsonPath);
         if(!astParser.run())
             return false;
 
-        std::vector<resman::ResourceInfo> resources = astParser.getResInfo();
+        resources = astParser.getResInfo();
+        dependencies = headerParser.getDependencies();
 
-        // Generate C++ sources
-        resman::ResCppSrcGenerator cppGen;
+        if (mOpts.useCache)
+            cache.store(resources, dependencies);
+
+        return true;
+    }
+
+    bool ResBuildOrchestrator::parseResourceHeaders(std::vector<ResourceInfo>& resources)
+    {
+        mResourceHeaders.clear();
+        if (mResInfo.has_value())
+        {
+            resources = *mResInfo;
+            mHeaderDeps.clear();
+            return true;
+        }
+
+        // one clang per header, all at once
+        std::vector<std::vector<ResourceInfo>> perHeader(mHeaderPaths.size());
+        std::vector<std::vector<std::string>> dependencies(mHeaderPaths.size());
+        std::vector<std::future<bool>> jobs;
+        for (size_t i = 0; i < mHeaderPaths.size(); ++i)
+        {
+            jobs.push_back(std::async(std::launch::async, &ResBuildOrchestrator::parseResourceHeader, this,
+                                      std::cref(mHeaderPaths[i]), i, std::ref(perHeader[i]), std::ref(dependencies[i])));
+        }
+
+        bool ok = true;
+        for (auto& job : jobs)
+            ok = job.get() && ok;
+        if (!ok)
+            return false;
+
+        mHeaderDeps.clear();
+        std::set<std::string> seen;
+        for (size_t i = 0; i < mHeaderPaths.size(); ++i)
+        {
+            // a header clang reported no dependencies for still is one
+            if (dependencies[i].empty())
+                dependencies[i].push_back(mHeaderPaths[i]);
+
+            for (const auto& dep : dependencies[i])
+                if (seen.insert(dep).second)
+                    mHeaderDeps.push_back(dep);
+        }
+
+        return mergeResources(perHeader, resources);
+    }
+
+    // Headers including each other report the same declarations more than once,
+    // which is fine; one id bound to two different files is not
+    bool ResBuildOrchestrator::mergeResources(const std::vector<std::vector<ResourceInfo>>& perHeader,
+                                              std::vector<ResourceInfo>& resources)
+    {
+        struct Origin
+        {
+            size_t index;   // into resources
+            size_t header;
+        };
+
+        std::map<std::string, Origin> byType;
+        std::map<std::string, std::string> typeByPath;
+        bool ok = true;
+
+        resources.clear();
+        for (size_t h = 0; h < perHeader.size(); ++h)
+        {
+            for (const auto& res : perHeader[h])
+            {
+                // the type ("resman::Resource<N>", maybe const-qualified) carries the id
+                std::string type = res.resType.substr(res.resType.find("resman::Resource<"));
+
+                auto [it, inserted] = byType.try_emplace(type, Origin{ resources.size(), h });
+                if (!inserted)
+                {
+                    const ResourceInfo& first = resources[it->second.index];
+                    if (first.resFilepath != res.resFilepath)
+                    {
+                        mLog.error() << "Error: " << type << " is declared as \"" << first.resFilepath << "\" in "
+                                     << mHeaderPaths[it->second.header] << " and as \"" << res.resFilepath << "\" in "
+                                     << mHeaderPaths[h];
+                        ok = false;
+                    }
+                    continue;
+                }
+
+                auto [pathIt, newPath] = typeByPath.try_emplace(res.resFilepath, type);
+                if (!newPath)
+                {
+                    mLog.warning() << "Warning: \"" << res.resFilepath << "\" is embedded twice, as "
+                                   << pathIt->second << " and " << type;
+                }
+
+                resources.push_back(res);
+                mResourceHeaders[type] = mHeaderPaths[h];
+            }
+        }
+
+        if (perHeader.size() > 1)
+            mLog.info() << "Merged " << resources.size() << " resources from " << perHeader.size() << " headers";
+
+        return ok;
+    }
+
+    bool ResBuildOrchestrator::run()
+    {
+        bool hasHeader = !mOpts.resHeader.empty() || !mOpts.resHeaders.empty() ||
+                         mHeaderSource.has_value() || mResInfo.has_value();
+        if (!hasHeader || mOpts.outputObj.empty())
+        {
+            mLog.error() << "Missing mandatory options (--res-header, --obj-name)";
+            return false;
+        }
+
+        if (mOpts.shardCount == 0 || mOpts.shardIndex >= mOpts.shardCount)
+        {
+            mLog.error() << "Invalid shard " << mOpts.shardIndex << "/" << mOpts.shardCount;
+            return false;
+        }
+
+        if (!mOpts.blobSymbol.empty() &&
+            (std::isdigit(static_cast<unsigned char>(mOpts.blobSymbol[0])) ||
+             !std::all_of(mOpts.blobSymbol.begin(), mOpts.blobSymbol.end(),
+                          [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; })))
+        {
+            mLog.error() << "Invalid --blob-symbol, not a C identifier: " << mOpts.blobSymbol;
+            return false;
+        }
+
+        mHeaderDeps.clear();
+        mResourceDeps.clear();
+
+        prepareWorkingDir();
+        bool ok = runStages();
+        cleanupWorkingDir();
+
+        if (ok && mOpts.verifyReproducible)
+            ok = verifyReproducible();
+        return ok;
+    }
+
+    std::vector<std::string> ResBuildOrchestrator::outputPaths() const
+    {
+        ResObjGenerator objGen;
+        objGen.setOutputObj(mOpts.outputObj)
+              .addTargetTriple(mOpts.targetTriples);
+
+        std::vector<std::string> paths;
+        if (mOpts.targetTriples.empty())
+            paths.push_back(objGen.getOutputObjPath(""));
+        for (const auto& triple : mOpts.targetTriples)
+            paths.push_back(objGen.getOutputObjPath(triple));
+        return paths;
+    }
+
+    // first differing byte, or -1 if the files are identical
+    std::string ResBuildOrchestrator::blobIndexSymbol() const
+    {
+        if (!mOpts.blobSymbol.empty())
+            return mOpts.blobSymbol;
+
+        std::string symbol = "resman_lite_blob_";
+        for (char c : fs::path(mOpts.outputObj).stem().string())
+            symbol.push_back(std::isalnum(static_cast<unsigned char>(c)) ? c : '_');
+        return symbol;
+    }
+
+    static std::int64_t firstDifference(const std::string& pathA, const std::string& pathB)
+    {
+        std::ifstream a(pathA, std::ios::binary), b(pathB, std::ios::binary);
+        if (!a || !b)
+            return 0;
+
+        std::vector<char> bufA(1 << 16), bufB(1 << 16);
+        std::int64_t offset = 0;
+        while (true)
+        {
+            a.read(bufA.data(), static_cast<std::streamsize>(bufA.size()));
+            b.read(bufB.data(), static_cast<std::streamsize>(bufB.size()));
+            std::streamsize countA = a.gcount(), countB = b.gcount();
+
+            auto mismatch = std::mismatch(bufA.begin(), bufA.begin() + std::min(countA, countB), bufB.begin());
+            if (mismatch.first != bufA.begin() + std::min(countA, countB) || countA != countB)
+                return offset + (mismatch.first - bufA.begin());
+
+            if (countA == 0)
+                return -1;
+            offset += countA;
+        }
+    }
 
-        // Create cpp output dir
+    // The same inputs built again in another temp dir, skipping the object
+    // cache: differences point at output depending on paths, timing or thread order
+    bool ResBuildOrchestrator::verifyReproducible()
+    {
+        const BuildOptions original = mOpts;
+        const std::vector<std::string> headerDeps = mHeaderDeps;
+        const std::vector<std::string> resourceDeps = mResourceDeps;
+        const std::vector<std::string> outputs = outputPaths();
+
+        fs::path verifyDir = fs::temp_directory_path() / ("resman-lite-verify-" + std::to_string(std::random_device{}()));
+        std::error_code ec;
+        fs::create_directories(verifyDir, ec);
+
+        mOpts.outputObj = (verifyDir / fs::path(original.outputObj).filename()).string();
+        mOpts.workingDir.reset();
+        mOpts.depFile.reset();
+        mOpts.sizeReport.reset();
+        mOpts.sizeBaseline.reset();
+        mOpts.sizeBudget.reset();
+        mOpts.writeIfChanged = false;
+        const std::vector<std::string> rebuilt = outputPaths();
+
+        mLog.info() << "Verifying reproducibility: building again into " << verifyDir.string();
+        mVerifying = true;
+        prepareWorkingDir();
+        bool ok = runStages();
+        cleanupWorkingDir();
+        mVerifying = false;
+
+        mOpts = original;
+        mHeaderDeps = headerDeps;
+        mResourceDeps = resourceDeps;
+
+        for (size_t i = 0; ok && i < outputs.size(); ++i)
+        {
+            if (!fs::exists(outputs[i], ec) || !fs::exists(rebuilt[i], ec))
+            {
+                mLog.error() << "Error: cannot verify " << outputs[i] << ": an output of the two builds is missing";
+                ok = false;
+                continue;
+            }
+
+            std::int64_t offset = firstDifference(outputs[i], rebuilt[i]);
+            if (offset >= 0)
+            {
+                mLog.error() << "Error: " << outputs[i] << " is not reproducible: a second build differs at byte "
+                             << offset << " (sizes " << fs::file_size(outputs[i], ec) << " and "
+                             << fs::file_size(rebuilt[i], ec) << ")";
+                ok = false;
+            }
+        }
+
+        if (ok)
+            mLog.info() << "Reproducible: " << outputs.size() << " output(s) identical across two builds";
+
+        fs::remove_all(verifyDir, ec);
+        return ok;
+    }
+
+    bool ResBuildOrchestrator::runStages()
+    {
+        if (!materializeHeaderSource())
+            return false;
+
+        std::vector<resman::ResourceInfo> resources;
+        if (!parseResourceHeaders(resources))
+            return false;
+
+        resources = selectShard(resources);
+
+        // Create cpp output dir; sources left over from a previous run in a
+        // reused working dir would otherwise be linked in as well
         std::string cppOutDir = mActiveWorkingDir + "/cpp_src_gen";
-        if (!fs::exists(cppOutDir))
-                fs::create_directories(cppOutDir);
+        fs::remove_all(cppOutDir);
+        fs::create_directories(cppOutDir);
+
+        if (resources.empty())
+        {
+            // an empty shard still has to produce its object for the build system
+            std::ofstream(cppOutDir + "/resman_lite_empty_shard.cpp") << "// Auto-generated by resman-lite (empty shard)\n";
+        }
+
+        // Generate C++ sources
+        resman::ResCppSrcGenerator cppGen;
 
-        cppGen.setOutputCppDir(cppOutDir)
+        cppGen.setLogCallback(mLog.getCallback())
+              .setOutputCppDir(cppOutDir)
               .setResourceInfo(resources)
-              .setResSearchPath(mOpts.resPaths);
+              .setResSearchPath(mOpts.resPaths)
+              .setEmitRegistry(mOpts.emitRegistry)
+              .setDevMode(mOpts.devMode)
+              .setDedupContent(mOpts.dedupContent)
+              .setBlobLayout(mOpts.blobLayout || mOpts.chunkDedup)
+              .setChunkDedup(mOpts.chunkDedup)
+              .setBlobIndexSymbol(blobIndexSymbol());
 
-        if (!cppGen.run())
-            return false;
+        for (const auto& [path, data] : mResData)
+            cppGen.addResourceData(path, data);
 
         // Generate .obj
         resman::ResObjGenerator objGen;
@@ -108,19 +503,266 @@ namespace resman
         if (!fs::exists(buildDir))
                 fs::create_directories(buildDir);
 
-        objGen.setInputCppDir(cppOutDir)
+        objGen.setLogCallback(mLog.getCallback())
+              .setInputCppDir(cppOutDir)
               .setWorkingDir(buildDir)
               .setOutputObj(mOpts.outputObj)
-              .setTargetTriple(mOpts.targetTriple)
+              .addTargetTriple(mOpts.targetTriples)
               .addIncludePath(mOpts.includePaths)
               .setClangPath(mOpts.clangPath)
               .setLlvmAsPath(mOpts.llvmAsPath)
               .setLlvmLinkPath(mOpts.llvmLinkPath)
-              .setLlcPath(mOpts.llcPath);
+              .setLlcPath(mOpts.llcPath)
+              .setLlvmArPath(mOpts.llvmArPath)
+              .setObjectCacheDir(objectCacheEnabled() ? (fs::path(resolveCacheDir()) / "objects").string() : "")
+              .setObjectCacheMaxBytes(mOpts.objectCacheMaxBytes)
+              .setWriteIfChanged(mOpts.writeIfChanged)
+              .setOutputKind(!mOpts.emitBitcode ? ObjOutputKind::Object
+                             : mOpts.thinLto    ? ObjOutputKind::ThinBitcode
+                                                : ObjOutputKind::Bitcode);
+
+        if (!resources.empty() && !cppGen.beginGeneration())
+            return false;
+
+        if (!objGen.beginBuild())
+            return false;
+
+        // One task graph for both generators: a resource is compiled as soon
+        // as its source is written, while later resources are still being read,
+        // and the link waits for all of them.
+        ResTaskGraph graph(mOpts.jobs);
+        graph.setLogCallback(mLog.getCallback());
+
+        std::vector<ResTaskGraph::TaskId> generated, compiled;
+        for (size_t i = 0; i < resources.size(); ++i)
+        {
+            auto generate = graph.addTask([&cppGen, i] {
+                cppGen.generateResource(i);
+                return true;
+            });
+
+            // skipped resources have no source
+            compiled.push_back(graph.addTask([&cppGen, &objGen, i] {
+                const std::string& cpp = cppGen.getGeneratedSource(i);
+                return cpp.empty() || objGen.compileModule(cpp);
+            }, { generate }));
+
+            generated.push_back(generate);
+        }
+
+        // registry source and link order need every resource
+        ResSizeReport sizeReport;
+        bool sizesCollected = false;
+        auto finishSources = graph.addTask([&] {
+            if (!resources.empty() && !cppGen.finishGeneration())
+                return false;
+
+            // dev-mode objects don't change with the resource contents, but
+            // every build changes once a missing resource appears (a missing
+            // dependency is out of date for Ninja and make)
+            if (!mOpts.devMode)
+                mResourceDeps = cppGen.getResolvedPaths();
+            const auto& missing = cppGen.getMissingPaths();
+            mResourceDeps.insert(mResourceDeps.end(), missing.begin(), missing.end());
+
+            // sizes are known once the sources are written: an exceeded
+            // budget fails the build before anything is compiled to objects
+            if (sizeReportEnabled())
+            {
+                collectSizes(resources, cppGen, sizeReport);
+                sizesCollected = true;
+
+                if (mOpts.sizeBudget.has_value())
+                {
+                    mResourceDeps.push_back(*mOpts.sizeBudget);
+                    if (!sizeReport.checkBudget(*mOpts.sizeBudget))
+                        return false;
+                }
+            }
+
+            std::vector<std::string> cppOrder;
+            if (!orderByProfile(cppGen, cppOrder))
+                return false;
 
-        if (!objGen.run())
+            objGen.setCppFileOrder(cppOrder);
+            return true;
+        }, generated);
+
+        compiled.push_back(finishSources);
+        graph.addTask([&objGen] { return objGen.finishBuild(); }, compiled);
+
+        bool built = graph.run();
+        std::vector<std::string> targets = outputPaths();
+
+        // also written when the budget failed the build, to see where the bytes went
+        if (sizesCollected && mOpts.sizeReport.has_value() && !mOpts.sizeReport->empty())
+        {
+            if (built)
+            {
+                for (const auto& target : targets)
+                    sizeReport.addOutput(target);
+            }
+
+            if (mOpts.sizeBaseline.has_value() && !mOpts.sizeBaseline->empty())
+                sizeReport.setBaseline(*mOpts.sizeBaseline);
+
+            if (!sizeReport.write(*mOpts.sizeReport))
+                return false;
+        }
+
+        if (!built)
             return false;
 
+        if (mOpts.depFile.has_value() && !mOpts.depFile->empty())
+        {
+            if (!writeDepFile(targets))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool ResBuildOrchestrator::sizeReportEnabled() const
+    {
+        return (mOpts.sizeReport.has_value() && !mOpts.sizeReport->empty()) ||
+               (mOpts.sizeBudget.has_value() && !mOpts.sizeBudget->empty());
+    }
+
+    void ResBuildOrchestrator::collectSizes(const std::vector<ResourceInfo>& resources, const ResCppSrcGenerator& cppGen,
+                                            ResSizeReport& report) const
+    {
+        report.setLogCallback(mLog.getCallback());
+
+        std::vector<GeneratedSize> sizes = cppGen.getResourceSizes();
+        for (size_t i = 0; i < resources.size(); ++i)
+        {
+            const ResourceInfo& res = resources[i];
+
+            ResourceSizeEntry entry;
+            entry.name = res.resName;
+            entry.path = res.resFilepath;
+
+            // resource info set in memory may spell the type differently; it
+            // has no declaring header then
+            auto prefix = res.resType.find("resman::Resource<");
+            if (prefix != std::string::npos)
+            {
+                auto header = mResourceHeaders.find(res.resType.substr(prefix));
+                if (header != mResourceHeaders.end())
+                    entry.header = header->second;
+            }
+
+            if (i < sizes.size() && sizes[i].generated)
+            {
+                entry.id = sizes[i].id;
+                entry.embedded = true;
+                entry.rawBytes = sizes[i].rawBytes;
+                entry.sourceBytes = sizes[i].sourceBytes;
+                entry.emittedBytes = sizes[i].emittedBytes;
+            }
+            else if (auto open = res.resType.find('<'); open != std::string::npos)
+            {
+                entry.id = static_cast<unsigned>(std::strtoul(res.resType.c_str() + open + 1, nullptr, 10));
+            }
+
+            report.addResource(entry);
+        }
+    }
+
+    std::vector<ResourceInfo> ResBuildOrchestrator::selectShard(const std::vector<ResourceInfo>& resources) const
+    {
+        if (mOpts.shardCount <= 1)
+            return resources;
+
+        std::vector<ResourceInfo> shard;
+        for (size_t i = mOpts.shardIndex; i < resources.size(); i += mOpts.shardCount)
+            shard.push_back(resources[i]);
+
+        mLog.info() << "Shard " << mOpts.shardIndex << "/" << mOpts.shardCount
+                    << ": " << shard.size() << " of " << resources.size() << " resources";
+        return shard;
+    }
+
+    bool ResBuildOrchestrator::orderByProfile(const ResCppSrcGenerator& cppGen, std::vector<std::string>& cppFiles)
+    {
+        if (mOpts.layoutProfiles.empty())
+            return true;
+
+        if ((mOpts.blobLayout || mOpts.chunkDedup) && !mOpts.devMode)
+        {
+            mLog.warning() << "Warning: layout profiles are not applied to the blob layout (declaration order)";
+            return true;
+        }
+
+        ResLayoutProfile profile;
+        profile.setLogCallback(mLog.getCallback());
+        for (const auto& path : mOpts.layoutProfiles)
+            profile.addProfile(path);
+
+        if (!profile.load())
+            return false;
+
+        std::map<unsigned, std::string> sources;
+        std::vector<unsigned> ids;
+        for (const auto& [id, cpp] : cppGen.getGeneratedSources())
+        {
+            sources.emplace(id, cpp);
+            ids.push_back(id);
+        }
+
+        for (unsigned id : profile.order(ids))
+            cppFiles.push_back(sources[id]);
+
+        // a new profile changes the layout
+        mResourceDeps.insert(mResourceDeps.end(), mOpts.layoutProfiles.begin(), mOpts.layoutProfiles.end());
+        return true;
+    }
+
+    // make-style escaping, understood by both make and ninja
+    static std::string escapeDepPath(const std::string& path)
+    {
+        std::string escaped;
+        for (char c : path)
+        {
+            if (c == ' ' || c == '#')
+                escaped.push_back('\\');
+            else if (c == '$')
+                escaped.push_back('$');
+            escaped.push_back(c);
+        }
+        return escaped;
+    }
+
+    bool ResBuildOrchestrator::writeDepFile(const std::vector<std::string>& targets) const
+    {
+        std::ofstream out(*mOpts.depFile);
+        if (!out)
+        {
+            mLog.error() << "Error: failed to write depfile: " << *mOpts.depFile;
+            return false;
+        }
+
+        for (size_t i = 0; i < targets.size(); ++i)
+            out << (i ? " " : "") << escapeDepPath(targets[i]);
+        out << ":";
+
+        // headers themselves are part of clang's dependency output
+        for (const auto& dep : mHeaderDeps)
+            out << " \\\n  " << escapeDepPath(dep);
+        for (const auto& dep : mResourceDeps)
+            out << " \\\n  " << escapeDepPath(dep);
+        out << "\n";
+
+        // missing resources get an empty rule (as with gcc -MP), so make
+        // rebuilds once they appear instead of stopping at them
+        std::error_code ec;
+        for (const auto& dep : mResourceDeps)
+        {
+            if (!fs::exists(dep, ec))
+                out << "\n" << escapeDepPath(dep) << ":\n";
+        }
+
+        mLog.info() << "Dependency file written: " << *mOpts.depFile;
         return true;
     }
 
@@ -0,0 +1,91 @@
+#include "ResChunker.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace resman
+{
+    namespace
+    {
+        constexpr std::uint64_t kCdcMaskSmall = 0x7fffull << 49;    // 15 bits: cuts are rare below the average size
+        constexpr std::uint64_t kCdcMaskLarge = 0x7ffull << 53;     // 11 bits: and frequent above it
+
+        const std::uint64_t* cdcGearTable()
+        {
+            // fixed pseudo-random values (splitmix64), so chunking is the same in every build
+            static const auto table = [] {
+                std::vector<std::uint64_t> gear(256);
+                std::uint64_t state = 0x7265736d616e6c74ull;
+                for (auto& value : gear)
+                {
+                    std::uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+                    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+                    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+                    value = z ^ (z >> 31);
+                }
+                return gear;
+            }();
+            return table.data();
+        }
+    }
+
+    std::size_t cdcCutPoint(const unsigned char* data, std::size_t size)
+    {
+        if (size <= kCdcMinBytes)
+            return size;
+
+        const std::uint64_t* gear = cdcGearTable();
+        std::size_t normal = std::min(size, kCdcAvgBytes);
+        std::size_t end = std::min(size, kCdcMaxBytes);
+        std::uint64_t hash = 0;
+        std::size_t i = kCdcMinBytes;
+        for (; i < normal; ++i)
+        {
+            hash = (hash << 1) + gear[data[i]];
+            if (!(hash & kCdcMaskSmall))
+                return i + 1;
+        }
+        for (; i < end; ++i)
+        {
+            hash = (hash << 1) + gear[data[i]];
+            if (!(hash & kCdcMaskLarge))
+                return i + 1;
+        }
+        return end;
+    }
+
+    std::uint64_t splitContentDefined(const std::function<std::size_t(char*, std::size_t)>& read, std::size_t bufferBytes,
+                                      const std::function<void(const char*, std::size_t)>& onChunk)
+    {
+        std::vector<char> buffer(std::max(bufferBytes, kCdcMaxBytes));
+        std::size_t filled = 0;
+        std::uint64_t total = 0;
+        bool eof = false;
+
+        while (true)
+        {
+            while (!eof && filled < buffer.size())
+            {
+                std::size_t n = read(buffer.data() + filled, buffer.size() - filled);
+                eof = (n == 0);
+                filled += n;
+            }
+
+            std::size_t start = 0;
+            while (filled - start >= kCdcMaxBytes || (eof && start < filled))
+            {
+                std::size_t cut = cdcCutPoint(reinterpret_cast<const unsigned char*>(buffer.data() + start), filled - start);
+                onChunk(buffer.data() + start, cut);
+                start += cut;
+                total += cut;
+            }
+
+            std::copy(buffer.begin() + start, buffer.begin() + filled, buffer.begin());
+            filled -= start;
+            if (eof && filled == 0)
+                break;
+        }
+
+        return total;
+    }
+}
@@ -1,14 +1,27 @@
 #include "ResCppSrcGenerator.h"
-#include <iostream>
+#include "ResJobServer.h"
+#include "ResHash.h"
+#include "ResChunker.h"
 #include <fstream>
 #include <sstream>
 #include <filesystem>
 #include <cctype>
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
 
 namespace fs = std::filesystem;
 
 namespace resman
 {
+    ResCppSrcGenerator::ResCppSrcGenerator() = default;
+    ResCppSrcGenerator::~ResCppSrcGenerator() = default;
+
     //──────────────────────────────
     // Setters
     //──────────────────────────────
@@ -41,23 +54,83 @@ namespace resman
         return *this;
     }
 
+    ResCppSrcGenerator& ResCppSrcGenerator::setLogCallback(LogCallback callback)
+    {
+        mLog.setCallback(std::move(callback));
+        return *this;
+    }
+
+    ResCppSrcGenerator& ResCppSrcGenerator::addResourceData(const std::string& resFilepath, std::string data)
+    {
+        mResData[resFilepath] = std::move(data);
+        return *this;
+    }
+
+    ResCppSrcGenerator& ResCppSrcGenerator::setEmitRegistry(bool enable)
+    {
+        mEmitRegistry = enable;
+        return *this;
+    }
+
+    ResCppSrcGenerator& ResCppSrcGenerator::setDevMode(bool enable)
+    {
+        mDevMode = enable;
+        return *this;
+    }
+
+    ResCppSrcGenerator& ResCppSrcGenerator::setDedupContent(bool enable)
+    {
+        mDedupContent = enable;
+        return *this;
+    }
+
+    ResCppSrcGenerator& ResCppSrcGenerator::setBlobLayout(bool enable)
+    {
+        mBlobLayout = enable;
+        return *this;
+    }
+
+    ResCppSrcGenerator& ResCppSrcGenerator::setChunkDedup(bool enable)
+    {
+        mChunkDedup = enable;
+        return *this;
+    }
+
+    ResCppSrcGenerator& ResCppSrcGenerator::setBlobIndexSymbol(const std::string& symbol)
+    {
+        mBlobIndexSymbol = symbol;
+        return *this;
+    }
+
+    ResCppSrcGenerator& ResCppSrcGenerator::setThreadCount(unsigned count)
+    {
+        mThreadCount = count;
+        return *this;
+    }
+
+    ResCppSrcGenerator& ResCppSrcGenerator::setMaxBytesInFlight(std::uint64_t bytes)
+    {
+        mMaxBytesInFlight = bytes;
+        return *this;
+    }
+
     //──────────────────────────────
     // Helpers
     //──────────────────────────────
     bool ResCppSrcGenerator::validateInputs() const
     {
         if (mOutputCppDir.empty()) {
-            std::cerr << "[ResCppSrcGenerator] Error: output .cpp directory not set.\n";
+            mLog.error() << "Error: output .cpp directory not set.";
             return false;
         }
 
         if (mResInfo.empty()) {
-            std::cerr << "[ResCppSrcGenerator] Error: no resource info provided.\n";
+            mLog.error() << "Error: no resource info provided.";
             return false;
         }
 
         if (!fs::exists(mOutputCppDir)) {
-            std::cerr << "[ResCppSrcGenerator] Error: output directory does not exist: " << mOutputCppDir << "\n";
+            mLog.error() << "Error: output directory does not exist: " << mOutputCppDir;
             return false;
         }
 
@@ -96,73 +169,831 @@ namespace resman
         return std::nullopt;
     }
 
-    //──────────────────────────────
-    // Core Generation
-    //──────────────────────────────
-     bool ResCppSrcGenerator::generateCppSource() const
+    namespace
     {
-        for (const auto& res : mResInfo)
+        constexpr std::size_t kReadBlockBytes   = 1 << 16;  // smallest read buffer per resource
+        constexpr std::size_t kWholeReadBytes   = 8 << 20;  // resources up to this size are read in one go
+        constexpr std::size_t kLiteralLineBytes = 64;       // bytes per string literal line
+
+        // clang limits a string literal to 4 GiB; bigger resources are pulled in
+        // by the assembler (.incbin) as consecutive chunks of this size
+        constexpr std::uint64_t kMaxLiteralBytes = 1ull << 30;
+
+        // Reads a resource in bounded blocks, from disk or from in-memory data
+        class ResourceReader
         {
-            auto resolved = resolveResourcePath(res.resFilepath, mResSearchPaths);
-            if (!resolved)
+        public:
+            explicit ResourceReader(const fs::path& path)
+                : mFile(path, std::ios::binary)
             {
-                std::cerr << "[ResCppSrcGenerator] Warning: could not locate resource: "
-                          << res.resFilepath << "\n";
-                continue;
+                std::error_code ec;
+                mSize = fs::file_size(path, ec);
+                mOk = mFile.is_open() && !ec;
             }
 
-            fs::path filePath = *resolved;
-            std::ifstream in(filePath, std::ios::binary);
-            if (!in)
+            explicit ResourceReader(const std::string& data)
+                : mData(&data), mSize(data.size()), mOk(true)
             {
-                std::cerr << "[ResCppSrcGenerator] Error: failed to read file: " << filePath << "\n";
-                continue;
             }
 
-            std::ostringstream buffer;
-            buffer << in.rdbuf();
-            std::string data = buffer.str();
+            bool ok() const { return mOk; }
+            std::uint64_t size() const { return mSize; }
+
+            std::size_t read(char* buffer, std::size_t count)
+            {
+                if (mData)
+                {
+                    std::size_t n = std::min<std::size_t>(count, mData->size() - mDataPos);
+                    std::copy_n(mData->data() + mDataPos, n, buffer);
+                    mDataPos += n;
+                    return n;
+                }
 
-            // Extract numeric ID from Resource type, e.g., "resman::Resource<1>"
+                mFile.read(buffer, static_cast<std::streamsize>(count));
+                return static_cast<std::size_t>(mFile.gcount());
+            }
+
+        private:
+            std::ifstream mFile;
+            const std::string* mData = nullptr;
+            std::size_t mDataPos = 0;
+            std::uint64_t mSize = 0;
+            bool mOk = false;
+        };
+
+        // "resman::Resource<1>" -> 1
+        unsigned extractResourceId(const std::string& type)
+        {
             unsigned id = 0;
-            const std::string& type = res.resType;
             auto start = type.find('<');
             auto end = type.find('>');
             if (start != std::string::npos && end != std::string::npos && end > start + 1)
-                id = std::stoi(type.substr(start + 1, end - start - 1));
+                id = static_cast<unsigned>(std::stoul(type.substr(start + 1, end - start - 1)));
+            return id;
+        }
+
+        // Itanium mangling of resman::Resource<id>::storage_begin
+        std::string mangledStorageBegin(unsigned id)
+        {
+            return "_ZN6resman8ResourceILj" + std::to_string(id) + "EE13storage_beginE";
+        }
+
+        // Printable bytes stay as they are, everything else becomes a 3-digit
+        // octal escape (which, unlike \x, can't swallow a following digit)
+        void writeEscapedByte(std::ostream& out, unsigned char c)
+        {
+            if (c >= 0x20 && c < 0x7f && c != '"' && c != '\\' && c != '?')
+            {
+                out.put(static_cast<char>(c));
+                return;
+            }
+
+            out.put('\\');
+            out.put(static_cast<char>('0' + ((c >> 6) & 7)));
+            out.put(static_cast<char>('0' + ((c >> 3) & 7)));
+            out.put(static_cast<char>('0' + (c & 7)));
+        }
+
+        // A file path as a quoted assembler string (quotes and backslashes
+        // escaped), itself written into a C string literal of an __asm__ block
+        void writeAsmPath(std::ostream& out, const std::string& path)
+        {
+            out << "\\\"";
+            for (char c : path)
+            {
+                if (c == '"' || c == '\\')
+                    writeEscapedByte(out, '\\');
+                writeEscapedByte(out, static_cast<unsigned char>(c));
+            }
+            out << "\\\"";
+        }
+
+        // Adjacent string literals, which the compiler concatenates into one
+        // contiguous array (plus a trailing NUL, not counted in storage_size).
+        // Much cheaper for clang than one initializer-list element per byte.
+        bool writeStringLiteral(std::ostream& out, ResourceReader& reader, std::size_t bufferBytes)
+        {
+            std::vector<char> buffer(bufferBytes);
+            std::uint64_t written = 0;
+
+            out << "\n    \"";
+            while (true)
+            {
+                std::size_t n = reader.read(buffer.data(), buffer.size());
+                if (n == 0)
+                    break;
 
-            // Output file = <basename>.cpp
-            fs::path cppName = fs::path(res.resFilepath).stem().string() + ".cpp";
-            fs::path outputPath = fs::path(mOutputCppDir) / cppName;
+                for (std::size_t i = 0; i < n; ++i, ++written)
+                {
+                    if (written > 0 && written % kLiteralLineBytes == 0)
+                        out << "\"\n    \"";
+                    writeEscapedByte(out, static_cast<unsigned char>(buffer[i]));
+                }
+            }
+            out << "\"";
+
+            return written == reader.size();
+        }
+
+        // Symbol (storage_begin, or the data of a --dedup-content resource)
+        // defined in module-level assembly, one .incbin per chunk
+        void writeIncbinChunks(std::ostream& out, unsigned id, const std::string& sym, const fs::path& file, std::uint64_t size)
+        {
+            std::string path = fs::absolute(file).generic_string();
+
+            out << "#if defined(_MSC_VER)\n";
+            out << "#error \"resman-lite: resources over " << kMaxLiteralBytes
+                << " bytes need a target with Itanium C++ mangling (ELF, Mach-O or MinGW)\"\n";
+            out << "#endif\n\n";
+
+            out << "#define RESMAN_LITE_STR2(x) #x\n";
+            out << "#define RESMAN_LITE_STR(x) RESMAN_LITE_STR2(x)\n";
+            out << "#define RESMAN_LITE_SYM(name) RESMAN_LITE_STR(__USER_LABEL_PREFIX__) name\n\n";
+
+            out << "__asm__(\n";
+            out << "#if defined(__APPLE__)\n";
+            out << "    \".section __TEXT,__const\\n\"\n";
+            out << "#elif defined(_WIN32)\n";
+            out << "    \".section .rdata,\\\"dr\\\"\\n\"\n";
+            out << "#else\n";
+            out << "    \".section .rodata,\\\"a\\\"\\n\"\n";
+            out << "#endif\n";
+            out << "    \".globl \" RESMAN_LITE_SYM(\"" << sym << "\") \"\\n\"\n";
+            out << "#if defined(__ELF__)\n";
+            out << "    \".type \" RESMAN_LITE_SYM(\"" << sym << "\") \", %object\\n\"\n";
+            out << "    \".size \" RESMAN_LITE_SYM(\"" << sym << "\") \", " << (size + 1) << "\\n\"\n";
+            out << "#endif\n";
+            out << "    RESMAN_LITE_SYM(\"" << sym << "\") \":\\n\"\n";
+
+            std::uint64_t chunk = 0;
+            for (std::uint64_t offset = 0; offset < size; offset += kMaxLiteralBytes, ++chunk)
+            {
+                std::uint64_t count = std::min(kMaxLiteralBytes, size - offset);
+                out << "    RESMAN_LITE_SYM(\"resman_lite_res" << id << "_chunk" << chunk << "\") \":\\n\"\n";
+                out << "    \".incbin ";
+                writeAsmPath(out, path);
+                out << ", " << offset << ", " << count << "\\n\"\n";
+            }
+
+            out << "    \".byte 0\\n\"\n";
+            out << "    \".text\\n\"\n";
+            out << ");\n\n";
+        }
+
+        // Streams the resource through the content-defined chunker (ResChunker.h)
+        bool splitContentDefined(ResourceReader& reader, std::size_t bufferBytes,
+                                 const std::function<void(const char*, std::size_t)>& onChunk)
+        {
+            std::uint64_t total = resman::splitContentDefined(
+                [&reader](char* data, std::size_t size) { return reader.read(data, size); }, bufferBytes, onChunk);
+            return total == reader.size();
+        }
+    }
+
+    // Bytes of read buffers held by all workers together
+    class ResCppSrcGenerator::ByteBudget
+    {
+    public:
+        explicit ByteBudget(std::uint64_t capacity)
+            : mCapacity(std::max<std::uint64_t>(capacity, kReadBlockBytes)), mAvailable(mCapacity)
+        {
+        }
+
+        // Blocks until the buffer fits; returns its size (wanted, within the per-resource limits)
+        std::size_t acquire(std::uint64_t wanted)
+        {
+            std::uint64_t limit = std::min<std::uint64_t>(kWholeReadBytes, mCapacity);
+            std::size_t bytes = static_cast<std::size_t>(std::clamp<std::uint64_t>(wanted, kReadBlockBytes, std::max<std::uint64_t>(limit, kReadBlockBytes)));
+
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCond.wait(lock, [&] { return mAvailable >= bytes; });
+            mAvailable -= bytes;
+            return bytes;
+        }
+
+        void release(std::size_t bytes)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mAvailable += bytes;
+            }
+            mCond.notify_all();
+        }
+
+    private:
+        std::mutex mMutex;
+        std::condition_variable mCond;
+        const std::uint64_t mCapacity;
+        std::uint64_t mAvailable;
+    };
+
+    //──────────────────────────────
+    // Core Generation
+    //──────────────────────────────
+    void ResCppSrcGenerator::writeResourceSource(const ResourceInfo& res, const std::string& baseName,
+                                                 ByteBudget& budget, GeneratedResource& result) const
+    {
+        // messages are replayed by finishGeneration() in declaration order
+        ResLogger log{ "ResCppSrcGenerator" };
+        log.setCallback([&result](LogLevel level, const std::string&, const std::string& message) {
+            result.messages.emplace_back(level, message);
+        });
+
+        unsigned id = extractResourceId(res.resType);
+        fs::path outputPath = fs::path(mOutputCppDir) / (baseName + ".cpp");
+
+        std::optional<ResourceReader> reader;
+        fs::path filePath;
+        auto inMemory = mResData.find(res.resFilepath);
+        if (inMemory != mResData.end() && mDevMode)
+        {
+            log.error() << "Error: in-memory resource " << res.resFilepath << " has no file for --dev-mode";
+            return;
+        }
+        else if (inMemory != mResData.end())
+        {
+            reader.emplace(inMemory->second);
+        }
+        else
+        {
+            auto resolved = resolveResourcePath(res.resFilepath, mResSearchPaths);
+            if (!resolved)
+            {
+                log.warning() << "Warning: could not locate resource: "
+                              << res.resFilepath;
+
+                std::error_code ec;
+                result.missingPaths.push_back(fs::absolute(res.resFilepath, ec).string());
+                for (const auto& dir : mResSearchPaths)
+                    result.missingPaths.push_back(fs::absolute(fs::path(dir) / res.resFilepath, ec).string());
+                return;
+            }
 
+            filePath = *resolved;
+            result.resolvedPath = filePath.string();
+            reader.emplace(filePath);
+        }
+
+        if (!reader->ok())
+        {
+            log.error() << "Error: failed to read file: " << filePath;
+            return;
+        }
+
+        std::uint64_t size = reader->size();
+        bool chunked = size > kMaxLiteralBytes;
+
+        // ResObjGenerator compiles every .cpp in the output dir, so a source
+        // that could not be completed must not stay there
+        auto discardOutput = [&outputPath](std::ofstream& out) {
+            out.close();
+            std::error_code ec;
+            fs::remove(outputPath, ec);
+        };
+
+        if (mDevMode)
+        {
             std::ofstream out(outputPath);
-            if (!out)
+            if (!writeDevModeSource(out, id, fs::absolute(filePath).string(), size))
             {
-                std::cerr << "[ResCppSrcGenerator] Error: failed to create: " << outputPath << "\n";
-                continue;
+                log.error() << "Error: failed to write: " << outputPath;
+                discardOutput(out);
+                result.failed = true;
+                return;
             }
 
-            out << "// Auto-generated by resman-lite\n";
-            out << "#include \"resman.h\"\n\n";
-            out << "namespace resman {\n\n";
+            log.info() << "Generated: " << outputPath << " for " << res.resFilepath << " (dev mode)";
+            result.generated = true;
+            result.id = id;
+            result.size = size;
+            result.sourceBytes = static_cast<std::uint64_t>(out.tellp());
+            result.emittedBytes = fs::absolute(filePath).string().size() + 1;
+            result.outputPath = outputPath.string();
+            return;
+        }
 
-            out << "    template<>\n";
-            out << "const char Resource<" << id << ">::storage_begin[] = {";
-            for (size_t i = 0; i < data.size(); ++i)
+        // .incbin needs a file, so oversized in-memory data is spilled next to the source
+        if ((chunked || mBlobLayout) && inMemory != mResData.end())
+        {
+            filePath = fs::path(mOutputCppDir) / (baseName + ".bin");
+            std::ofstream(filePath, std::ios::binary).write(inMemory->second.data(),
+                                                           static_cast<std::streamsize>(size));
+        }
+
+        // the blob source written by finishGeneration() .incbin's the file in place
+        if (mBlobLayout)
+        {
+            if (mChunkDedup)
             {
-                if (i % 12 == 0) out << "\n    ";
-                out << static_cast<unsigned int>(static_cast<unsigned char>(data[i])) << ",";
+                std::size_t bufferBytes = budget.acquire(size);
+                bool ok = splitContentDefined(*reader, bufferBytes, [&result](const char* data, std::size_t count) {
+                    std::string hash = ResHasher().update(data, count).hexDigest().substr(0, 32);
+                    std::uint64_t offset = result.chunks.empty() ? 0 : result.chunks.back().offset + result.chunks.back().size;
+                    result.chunks.push_back({ offset, static_cast<std::uint32_t>(count), std::move(hash) });
+                });
+                budget.release(bufferBytes);
+
+                if (!ok)
+                {
+                    log.error() << "Error: failed to read file: " << filePath;
+                    result.chunks.clear();
+                    return;
+                }
             }
-            out << "\n};\n\n";
 
+            log.info() << "Added to blob: " << filePath;
+            result.generated = true;
+            result.id = id;
+            result.size = size;
+            result.emittedBytes = size + 1;
+            result.blobFile = fs::absolute(filePath).generic_string();
+            return;
+        }
+
+        // With --dedup-content the bytes become a C++17 inline variable named
+        // after their hash, which compilers emit in a COMDAT (selectany on COFF,
+        // a weak definition on Mach-O): the linker keeps one copy for all objects
+        // and libraries embedding the same data, and Resource<N>::storage_view
+        // points at it. .incbin'd chunks can't be folded portably and keep a
+        // per-resource symbol.
+        std::string contentSym;
+        if (mDedupContent && chunked)
+        {
+            contentSym = "resman_lite_res" + std::to_string(id) + "_data";
+        }
+        else if (mDedupContent)
+        {
+            auto hash = (inMemory != mResData.end()) ? std::optional<std::string>(ResHasher::hashString(inMemory->second))
+                                                     : ResHasher::hashFile(filePath.string());
+            if (!hash)
+            {
+                log.error() << "Error: failed to read file: " << filePath;
+                return;
+            }
+            contentSym = "c" + hash->substr(0, 32);
+        }
+
+        std::ofstream out(outputPath);
+        if (!out)
+        {
+            log.error() << "Error: failed to create: " << outputPath;
+            return;
+        }
+
+        out << "// Auto-generated by resman-lite\n";
+        if (mDedupContent)
+            out << "#ifndef RESMAN_DEDUP_CONTENT\n#define RESMAN_DEDUP_CONTENT 1\n#endif\n";
+        out << "#include \"resman.h\"\n\n";
+
+        if (chunked)
+            writeIncbinChunks(out, id, mDedupContent ? contentSym : mangledStorageBegin(id), filePath, size);
+
+        if (mDedupContent && chunked)
+            out << "extern \"C\" const char " << contentSym << "[];\n\n";
+        else if (mDedupContent)
+        {
+            out << "#if __cplusplus < 201703L && (!defined(_MSVC_LANG) || _MSVC_LANG < 201703L)\n";
+            out << "#error \"resman-lite: --dedup-content sources need C++17 (inline variables)\"\n";
+            out << "#endif\n\n";
+        }
+
+        out << "namespace resman {\n\n";
+
+        if (!chunked)
+        {
+            if (mDedupContent)
+            {
+                out << "namespace content {\n\n";
+                out << "    inline const char " << contentSym << "[] =";
+            }
+            else
+            {
+                out << "    template<>\n";
+                out << "const char Resource<" << id << ">::storage_begin[] =";
+            }
+
+            // small resources are read with a single call, big ones in budgeted blocks
+            std::size_t bufferBytes = budget.acquire(size);
+            bool ok = writeStringLiteral(out, *reader, bufferBytes);
+            budget.release(bufferBytes);
+
+            if (!ok)
+            {
+                log.error() << "Error: failed to read file: " << filePath;
+                discardOutput(out);
+                return;
+            }
+            out << ";\n\n";
+
+            if (mDedupContent)
+            {
+                out << "} // namespace content\n\n";
+                contentSym = "content::" + contentSym;
+            }
+        }
+
+        if (mDedupContent)
+        {
+            out << "    template<>\n";
+            out << "const detail::DataView Resource<" << id << ">::storage_view = { " << contentSym << ", " << size << "ull };\n\n";
+        }
+        else
+        {
             out << "    template<>\n";
-            out << "const unsigned Resource<" << id << ">::storage_size = " << data.size() << "u;\n\n";
+            out << "const std::size_t Resource<" << id << ">::storage_size = " << size << "ull;\n\n";
+        }
+
+        out << "} // namespace resman\n";
+
+        if (!out)
+        {
+            log.error() << "Error: failed to write: " << outputPath;
+            discardOutput(out);
+            result.failed = true;
+            return;
+        }
+
+        log.info() << "Generated: " << outputPath << " for " << res.resFilepath << (chunked ? " (chunked)" : "");
+        result.generated = true;
+        result.id = id;
+        result.size = size;
+        result.sourceBytes = static_cast<std::uint64_t>(out.tellp());
+        result.emittedBytes = size + 1;
+        result.outputPath = outputPath.string();
+    }
+
+    bool ResCppSrcGenerator::writeDevModeSource(std::ostream& out, unsigned id, const std::string& filePath,
+                                                std::uint64_t size) const
+    {
+        out << "// Auto-generated by resman-lite (dev mode: read from disk at run time)\n";
+        out << "#ifndef RESMAN_DEV_MODE\n";
+        out << "#define RESMAN_DEV_MODE 1\n";
+        out << "#endif\n";
+        out << "#include \"resman.h\"\n\n";
+        out << "namespace resman {\n\n";
+
+        out << "    template<>\n";
+        out << "const detail::DevResourceInfo Resource<" << id << ">::storage_info = {\n    \"";
+        for (char c : filePath)
+            writeEscapedByte(out, static_cast<unsigned char>(c));
+        out << "\",\n    " << size << "ull\n};\n\n";
+
+        out << "} // namespace resman\n";
+        return static_cast<bool>(out);
+    }
+
+    bool ResCppSrcGenerator::beginGeneration()
+    {
+        if (!validateInputs())
+            return false;
+
+        mResolvedPaths.clear();
+        mMissingPaths.clear();
+        mGeneratedSources.clear();
+
+        // Output file = resman_lite_res<id>.cpp, named after the id rather than
+        // the resource file: renaming a file, or adding another one with the same
+        // name, leaves every other module (and its link position) unchanged
+        mBaseNames.clear();
+        for (const auto& res : mResInfo)
+            mBaseNames.push_back("resman_lite_res" + std::to_string(extractResourceId(res.resType)));
+
+        if (mDedupContent && mDevMode)
+            mLog.warning() << "Warning: content deduplication does not apply in dev mode";
+        if (mBlobLayout && mDevMode)
+            mLog.warning() << "Warning: the blob layout does not apply in dev mode";
+        else if (mBlobLayout && mDedupContent)
+            mLog.warning() << "Warning: content deduplication does not apply to the blob layout";
+        if (mChunkDedup && !mBlobLayout)
+            mLog.warning() << "Warning: chunk deduplication needs the blob layout, not applied";
+
+        mResults.assign(mResInfo.size(), GeneratedResource{});
+        mBudget = std::make_unique<ByteBudget>(mMaxBytesInFlight);
+        return true;
+    }
+
+    void ResCppSrcGenerator::generateResource(size_t index)
+    {
+        // under make -jN, every resource counts against the outer job limit
+        auto token = ResJobServer::instance().acquire();
+        writeResourceSource(mResInfo[index], mBaseNames[index], *mBudget, mResults[index]);
+    }
+
+    bool ResCppSrcGenerator::generateCppSource()
+    {
+        // Worker threads pick the next resource until none are left; reads of
+        // one thread overlap the encoding and writing of the others
+        std::atomic<size_t> next{ 0 };
+
+        auto worker = [&]() {
+            for (size_t i = next++; i < mResInfo.size(); i = next++)
+                generateResource(i);
+        };
+
+        unsigned threadCount = mThreadCount ? mThreadCount : std::max(1u, std::thread::hardware_concurrency());
+        threadCount = static_cast<unsigned>(std::min<size_t>(threadCount, mResInfo.size()));
+
+        std::vector<std::thread> threads;
+        for (unsigned t = 1; t < threadCount; ++t)
+            threads.emplace_back(worker);
+        worker();
+        for (auto& thread : threads)
+            thread.join();
+
+        return finishGeneration();
+    }
+
+    bool ResCppSrcGenerator::finishGeneration()
+    {
+        bool ok = true;
+        std::vector<std::pair<unsigned, std::uint64_t>> generated;
+        for (const auto& result : mResults)
+        {
+            for (const auto& [level, message] : result.messages)
+                mLog.log(level, message);
+
+            if (!result.resolvedPath.empty())
+                mResolvedPaths.push_back(result.resolvedPath);
+            mMissingPaths.insert(mMissingPaths.end(), result.missingPaths.begin(), result.missingPaths.end());
+            if (result.generated)
+                generated.emplace_back(result.id, result.size);
+            if (!result.outputPath.empty())
+                mGeneratedSources.emplace_back(result.id, result.outputPath);
+            ok = ok && !result.failed;
+        }
+
+        mBudget.reset();
 
-            out << "} // namespace resman\n";
+        if (!ok)
+            return false;
 
-            std::cout << "[ResCppSrcGenerator] Generated: " << outputPath << "\n";
+        if (mBlobLayout && !mDevMode)
+        {
+            return generated.empty() || generateBlobSource();
         }
 
+        if (mEmitRegistry && mDevMode)
+        {
+            mLog.warning() << "Warning: the resource registry is not available in dev mode, not generated";
+            return true;
+        }
+
+        if (mEmitRegistry)
+            return generateRegistrySource(generated);
+
+        return true;
+    }
+
+    std::vector<GeneratedSize> ResCppSrcGenerator::getResourceSizes() const
+    {
+        std::vector<GeneratedSize> sizes;
+        for (const auto& result : mResults)
+        {
+            GeneratedSize size;
+            size.generated = result.generated;
+            size.id = result.id;
+            size.rawBytes = result.size;
+            size.sourceBytes = result.sourceBytes;
+            size.emittedBytes = result.emittedBytes;
+            sizes.push_back(size);
+        }
+        return sizes;
+    }
+
+    // All resources as one local symbol in module-level assembly, each file
+    // .incbin'd in place (plus a NUL, as with the string literals), and an
+    // index of plain integers relative to it, sorted by id. The index is the
+    // only symbol of the object, whatever the number of resources; a pointer
+    // to it goes into a section the linker gathers into one table, where
+    // resman.h looks resources up by id.
+    bool ResCppSrcGenerator::generateBlobSource()
+    {
+        fs::path outputPath = fs::path(mOutputCppDir) / "resman_lite_blob.cpp";
+        std::ofstream out(outputPath);
+        if (!out)
+        {
+            mLog.error() << "Error: failed to create: " << outputPath;
+            return false;
+        }
+
+        std::vector<BlobEntry> entries;
+        std::vector<std::pair<std::uint64_t, std::uint32_t>> segments;   // --chunk-dedup: offset, size
+        std::vector<std::string> blobFiles;
+        std::uint64_t blobSize = 0;
+        if (mChunkDedup)
+        {
+            std::string storePath = (fs::path(mOutputCppDir) / "resman_lite_chunks.bin").string();
+            if (!writeChunkStore(storePath, entries, segments, blobSize))
+                return false;
+
+            blobFiles.push_back(fs::absolute(storePath).generic_string());
+            blobSize += 1;
+        }
+        else
+        {
+            for (const auto& result : mResults)
+            {
+                if (!result.generated)
+                    continue;
+
+                entries.push_back({ result.id, blobSize, result.size });
+                blobFiles.push_back(result.blobFile);
+                blobSize += result.size + 1;
+            }
+        }
+        std::sort(entries.begin(), entries.end(), [](const BlobEntry& a, const BlobEntry& b) { return a.id < b.id; });
+
+        bool wide = blobSize > 0xffffffffull;
+
+        out << "// Auto-generated by resman-lite (blob layout)\n";
+        out << "#ifndef RESMAN_BLOB_LAYOUT\n";
+        out << "#define RESMAN_BLOB_LAYOUT 1\n";
+        out << "#endif\n";
+        out << "#include \"resman.h\"\n\n";
+
+        out << "#define RESMAN_LITE_STR2(x) #x\n";
+        out << "#define RESMAN_LITE_STR(x) RESMAN_LITE_STR2(x)\n";
+        out << "#define RESMAN_LITE_SYM(name) RESMAN_LITE_STR(__USER_LABEL_PREFIX__) name\n\n";
+
+        out << "__asm__(\n";
+        out << "#if defined(__APPLE__)\n";
+        out << "    \".section __TEXT,__const\\n\"\n";
+        out << "#elif defined(_WIN32)\n";
+        out << "    \".section .rdata,\\\"dr\\\"\\n\"\n";
+        out << "#else\n";
+        out << "    \".section .rodata,\\\"a\\\"\\n\"\n";
+        out << "#endif\n";
+        out << "#if defined(__ELF__)\n";
+        out << "    \".type \" RESMAN_LITE_SYM(\"resman_lite_blob\") \", %object\\n\"\n";
+        out << "    \".size \" RESMAN_LITE_SYM(\"resman_lite_blob\") \", " << blobSize << "\\n\"\n";
+        out << "#endif\n";
+        out << "    RESMAN_LITE_SYM(\"resman_lite_blob\") \":\\n\"\n";
+        for (const auto& file : blobFiles)
+        {
+            out << "    \".incbin ";
+            writeAsmPath(out, file);
+            out << "\\n\"\n";
+            out << "    \".byte 0\\n\"\n";
+        }
+        out << "    \".text\\n\"\n";
+        out << ");\n\n";
+
+        out << "extern \"C\" const char resman_lite_blob[];\n\n";
+        out << "namespace {\n\n";
+
+        // id, offset from the blob (first segment with --chunk-dedup), size
+        out << "    const resman::detail::BlobEntry" << (wide ? "64" : "32") << " entries[] = {\n";
+        for (const auto& entry : entries)
+            out << "        { " << entry.id << ", " << entry.offset << "u, " << entry.size << "u },\n";
+        out << "    };\n\n";
+
+        if (mChunkDedup)
+        {
+            // offset from the blob, size
+            out << "    const resman::detail::BlobSegment segments[] = {\n";
+            for (const auto& [offset, size] : segments)
+                out << "        { " << offset << "u, " << size << "u },\n";
+            if (segments.empty())
+                out << "        { 0u, 0u },\n";
+            out << "    };\n\n";
+
+            // buffers of resources assembled from several segments, set on first access
+            out << "    std::atomic<const char*> assembled[" << std::max<size_t>(entries.size(), 1) << "];\n\n";
+        }
+
+        out << "} // namespace\n\n";
+
+        out << "extern \"C\" const resman::detail::BlobIndex " << mBlobIndexSymbol << " = { resman_lite_blob, "
+            << (wide ? "nullptr, entries, " : "entries, nullptr, ") << (mChunkDedup ? "segments, assembled" : "nullptr, nullptr")
+            << ", " << entries.size() << " };\n\n";
+
+        out << "namespace {\n";
+        out << "    RESMAN_BLOB_TABLE_SLOT const resman::detail::BlobIndex* const blob_index_slot = &" << mBlobIndexSymbol << ";\n";
+        out << "}\n\n";
+
+        // bounds of the table on COFF, which has no linker-defined ones: grouped
+        // sections are sorted by the name after '$', and one copy of each is kept
+        out << "#if defined(_WIN32)\n";
+        out << "extern \"C\" RESMAN_BLOB_TABLE_BOUND(\"a\") const resman::detail::BlobIndex* const resman_lite_blobs_begin[1] = { nullptr };\n";
+        out << "extern \"C\" RESMAN_BLOB_TABLE_BOUND(\"z\") const resman::detail::BlobIndex* const resman_lite_blobs_end[1] = { nullptr };\n";
+        out << "#endif\n";
+
+        if (!out)
+        {
+            mLog.error() << "Error: failed to write: " << outputPath;
+            return false;
+        }
+
+        mLog.info() << "Generated: " << outputPath << " (" << entries.size() << " resources, " << blobSize << " bytes)";
+        return true;
+    }
+
+    // Every distinct chunk once, in first-use order; each resource becomes a run
+    // of consecutive segments referring into the store
+    bool ResCppSrcGenerator::writeChunkStore(const std::string& storePath, std::vector<BlobEntry>& entries,
+                                             std::vector<std::pair<std::uint64_t, std::uint32_t>>& segments,
+                                             std::uint64_t& storeSize)
+    {
+        std::ofstream store(storePath, std::ios::binary);
+        if (!store)
+        {
+            mLog.error() << "Error: failed to create: " << storePath;
+            return false;
+        }
+
+        std::map<std::string, std::uint64_t> stored;   // chunk hash -> store offset
+        std::vector<char> buffer;
+        std::uint64_t totalBytes = 0;
+        storeSize = 0;
+
+        for (auto& result : mResults)
+        {
+            if (!result.generated)
+                continue;
+
+            entries.push_back({ result.id, segments.size(), result.size });
+            result.emittedBytes = 0;
+            totalBytes += result.size;
+
+            std::ifstream in(result.blobFile, std::ios::binary);
+            for (const auto& chunk : result.chunks)
+            {
+                auto [it, inserted] = stored.emplace(chunk.hash, storeSize);
+                if (inserted)
+                {
+                    buffer.resize(chunk.size);
+                    in.seekg(static_cast<std::streamoff>(chunk.offset));
+                    in.read(buffer.data(), static_cast<std::streamsize>(chunk.size));
+                    if (in.gcount() != static_cast<std::streamsize>(chunk.size))
+                    {
+                        mLog.error() << "Error: failed to read file: " << result.blobFile;
+                        return false;
+                    }
+
+                    store.write(buffer.data(), static_cast<std::streamsize>(chunk.size));
+                    storeSize += chunk.size;
+                    result.emittedBytes += chunk.size;   // a chunk is charged to its first user
+                }
+
+                // chunks stored back to back stay one segment, so a resource
+                // made of new or repeated runs is read in place
+                bool extends = entries.back().offset < segments.size() &&
+                               segments.back().first + segments.back().second == it->second &&
+                               segments.back().second + std::uint64_t(chunk.size) <= 0xffffffffull;
+                if (extends)
+                    segments.back().second += chunk.size;
+                else
+                    segments.emplace_back(it->second, chunk.size);
+            }
+        }
+
+        if (!store)
+        {
+            mLog.error() << "Error: failed to write: " << storePath;
+            return false;
+        }
+
+        mLog.info() << "Chunk dedup: " << storeSize << " of " << totalBytes << " bytes stored, "
+                    << stored.size() << " unique chunks";
+        return true;
+    }
+
+    bool ResCppSrcGenerator::generateRegistrySource(const std::vector<std::pair<unsigned, std::uint64_t>>& generated) const
+    {
+        fs::path outputPath = fs::path(mOutputCppDir) / "resman_lite_registry.cpp";
+        std::ofstream out(outputPath);
+        if (!out)
+        {
+            mLog.error() << "Error: failed to create: " << outputPath;
+            return false;
+        }
+
+        out << "// Auto-generated by resman-lite\n";
+        if (mDedupContent)
+            out << "#ifndef RESMAN_DEDUP_CONTENT\n#define RESMAN_DEDUP_CONTENT 1\n#endif\n";
+        out << "#include \"resman.h\"\n\n";
+        out << "namespace {\n\n";
+
+        // constant-initialized, so only the list insertion runs at startup
+        // (with --dedup-content the entries are filled in just before it)
+        out << "    const resman::detail::RegistryEntry entries[] = {\n";
+        for (const auto& [id, size] : generated)
+            out << "        { " << id << ", resman::detail::ResourceAccess::begin<" << id << ">(), " << size << "ull },\n";
+        if (generated.empty())
+            out << "        { 0, nullptr, 0 },\n";
+        out << "    };\n\n";
+
+        out << "    resman::detail::RegistryNode node{ entries, " << generated.size() << ", nullptr };\n";
+        out << "    const resman::detail::Registrar registrar(node);\n\n";
+        out << "} // namespace\n";
+
+        if (!out)
+        {
+            mLog.error() << "Error: failed to write: " << outputPath;
+            return false;
+        }
+
+        mLog.info() << "Generated: " << outputPath;
         return true;
     }
 
@@ -171,7 +1002,7 @@ namespace resman
     //──────────────────────────────
     bool ResCppSrcGenerator::run()
     {
-        if (!validateInputs())
+        if (!beginGeneration())
             return false;
 
         return generateCppSource();
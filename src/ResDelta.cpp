@@ -0,0 +1,535 @@
+#include "ResDelta.h"
+#include "ResChunker.h"
+#include "ResHash.h"
+
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+
+namespace fs = std::filesystem;
+
+namespace resman
+{
+    namespace
+    {
+        const char kMagic[8] = { 'R', 'M', 'D', 'E', 'L', 'T', 'A', '1' };
+
+        enum DeltaOp : unsigned char
+        {
+            kOpEnd = 0,
+            kOpRef = 1,     // chunk hash, length: old bytes starting at that chunk
+            kOpCopy = 2,    // old offset, length
+            kOpData = 3     // length, bytes
+        };
+
+        constexpr std::size_t kChunkKeyBytes = 16;
+        constexpr std::size_t kHashBytes = 32;
+        constexpr std::size_t kMinCopyBytes = 32;           // shorter matches cost more as ops than as data
+        constexpr std::size_t kMaxPendingData = 4 << 20;
+        constexpr std::size_t kIoBlockBytes = 1 << 20;
+
+        std::string hexToBytes(const std::string& hex)
+        {
+            auto nibble = [](char ch) {
+                return static_cast<unsigned char>(ch <= '9' ? ch - '0' : ch - 'a' + 10);
+            };
+
+            std::string bytes(hex.size() / 2, '\0');
+            for (size_t i = 0; i < bytes.size(); ++i)
+                bytes[i] = static_cast<char>((nibble(hex[2 * i]) << 4) | nibble(hex[2 * i + 1]));
+            return bytes;
+        }
+
+        std::string chunkKey(const char* data, std::size_t size)
+        {
+            return hexToBytes(ResHasher().update(data, size).hexDigest().substr(0, 2 * kChunkKeyBytes));
+        }
+
+        void writeU64(std::ostream& out, std::uint64_t value)
+        {
+            char bytes[8];
+            for (int i = 0; i < 8; ++i)
+                bytes[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+            out.write(bytes, 8);
+        }
+
+        bool readU64(std::istream& in, std::uint64_t& value)
+        {
+            unsigned char bytes[8];
+            if (!in.read(reinterpret_cast<char*>(bytes), 8))
+                return false;
+            value = 0;
+            for (int i = 0; i < 8; ++i)
+                value |= std::uint64_t(bytes[i]) << (8 * i);
+            return true;
+        }
+
+        // Content-defined chunks of a file: first offset of every chunk hash,
+        // plus the file's size and SHA-256 (raw), all in one pass
+        struct ChunkIndex
+        {
+            std::unordered_map<std::string, std::uint64_t> offsets;
+            std::uint64_t size = 0;
+            std::string hash;
+        };
+
+        bool indexFile(const std::string& path, ChunkIndex& index)
+        {
+            std::ifstream in(path, std::ios::binary);
+            if (!in)
+                return false;
+
+            ResHasher hasher;
+            index.size = splitContentDefined(
+                [&in](char* data, std::size_t size) {
+                    in.read(data, static_cast<std::streamsize>(size));
+                    return static_cast<std::size_t>(in.gcount());
+                },
+                kIoBlockBytes,
+                [&](const char* data, std::size_t size) {
+                    index.offsets.emplace(chunkKey(data, size), index.size);
+                    index.size += size;
+                    hasher.update(data, size);
+                });
+
+            index.hash = hexToBytes(hasher.hexDigest());
+            return !in.bad();
+        }
+
+        bool readAt(std::istream& in, std::uint64_t offset, char* data, std::size_t size)
+        {
+            in.clear();
+            in.seekg(static_cast<std::streamoff>(offset));
+            in.read(data, static_cast<std::streamsize>(size));
+            return static_cast<std::size_t>(in.gcount()) == size;
+        }
+
+        // Writes the ops in order; of ref, copy and data only one is open at a time
+        class DeltaWriter
+        {
+        public:
+            explicit DeltaWriter(std::ostream& out) : mOut(out) {}
+
+            void ref(const std::string& key, std::uint64_t oldOffset, std::uint64_t size)
+            {
+                if (mRefSize && mRefOffset + mRefSize == oldOffset)
+                {
+                    mRefSize += size;
+                    return;
+                }
+
+                flush();
+                mRefKey = key;
+                mRefOffset = oldOffset;
+                mRefSize = size;
+            }
+
+            void copy(std::uint64_t oldOffset, std::uint64_t size)
+            {
+                if (mCopySize && mCopyOffset + mCopySize == oldOffset)
+                {
+                    mCopySize += size;
+                    return;
+                }
+
+                flush();
+                mCopyOffset = oldOffset;
+                mCopySize = size;
+            }
+
+            void data(const char* bytes, std::size_t size)
+            {
+                if (mRefSize || mCopySize || mData.size() >= kMaxPendingData)
+                    flush();
+                mData.append(bytes, size);
+            }
+
+            void flush()
+            {
+                if (mRefSize)
+                {
+                    mOut.put(static_cast<char>(kOpRef));
+                    mOut.write(mRefKey.data(), static_cast<std::streamsize>(mRefKey.size()));
+                    writeU64(mOut, mRefSize);
+                    refBytes += mRefSize;
+                    mRefSize = 0;
+                }
+                if (mCopySize)
+                {
+                    mOut.put(static_cast<char>(kOpCopy));
+                    writeU64(mOut, mCopyOffset);
+                    writeU64(mOut, mCopySize);
+                    copyBytes += mCopySize;
+                    mCopySize = 0;
+                }
+                if (!mData.empty())
+                {
+                    mOut.put(static_cast<char>(kOpData));
+                    writeU64(mOut, mData.size());
+                    mOut.write(mData.data(), static_cast<std::streamsize>(mData.size()));
+                    dataBytes += mData.size();
+                    mData.clear();
+                }
+            }
+
+            std::uint64_t refBytes = 0;
+            std::uint64_t copyBytes = 0;
+            std::uint64_t dataBytes = 0;
+
+        private:
+            std::ostream& mOut;
+            std::string mRefKey;
+            std::uint64_t mRefOffset = 0;
+            std::uint64_t mRefSize = 0;
+            std::uint64_t mCopyOffset = 0;
+            std::uint64_t mCopySize = 0;
+            std::string mData;
+        };
+    }
+
+    //──────────────────────────────
+    // Setters
+    //──────────────────────────────
+    ResDeltaGenerator& ResDeltaGenerator::setOldFile(const std::string& path)
+    {
+        mOldFile = path;
+        return *this;
+    }
+
+    ResDeltaGenerator& ResDeltaGenerator::setNewFile(const std::string& path)
+    {
+        mNewFile = path;
+        return *this;
+    }
+
+    ResDeltaGenerator& ResDeltaGenerator::setDeltaFile(const std::string& path)
+    {
+        mDeltaFile = path;
+        return *this;
+    }
+
+    ResDeltaGenerator& ResDeltaGenerator::setLogCallback(LogCallback callback)
+    {
+        mLog.setCallback(std::move(callback));
+        return *this;
+    }
+
+    ResDeltaApplier& ResDeltaApplier::setOldFile(const std::string& path)
+    {
+        mOldFile = path;
+        return *this;
+    }
+
+    ResDeltaApplier& ResDeltaApplier::setDeltaFile(const std::string& path)
+    {
+        mDeltaFile = path;
+        return *this;
+    }
+
+    ResDeltaApplier& ResDeltaApplier::setOutputFile(const std::string& path)
+    {
+        mOutputFile = path;
+        return *this;
+    }
+
+    ResDeltaApplier& ResDeltaApplier::setLogCallback(LogCallback callback)
+    {
+        mLog.setCallback(std::move(callback));
+        return *this;
+    }
+
+    //──────────────────────────────
+    // Delta generation
+    //──────────────────────────────
+    bool ResDeltaGenerator::validateInputs() const
+    {
+        if (mOldFile.empty() || mNewFile.empty() || mDeltaFile.empty())
+        {
+            mLog.error() << "Error: old file, new file and delta file must be set.";
+            return false;
+        }
+
+        for (const auto& path : { mOldFile, mNewFile })
+        {
+            if (!fs::is_regular_file(path))
+            {
+                mLog.error() << "Error: file does not exist: " << path;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool ResDeltaGenerator::run()
+    {
+        if (!validateInputs())
+            return false;
+
+        ChunkIndex old;
+        if (!indexFile(mOldFile, old))
+        {
+            mLog.error() << "Error: failed to read file: " << mOldFile;
+            return false;
+        }
+
+        std::ifstream oldIn(mOldFile, std::ios::binary);
+        std::ifstream newIn(mNewFile, std::ios::binary);
+        std::ofstream out(mDeltaFile, std::ios::binary | std::ios::trunc);
+        if (!oldIn || !newIn || !out)
+        {
+            mLog.error() << "Error: failed to open " << mOldFile << ", " << mNewFile << " or " << mDeltaFile;
+            return false;
+        }
+
+        // the new file's size and hash are filled in at the end
+        out.write(kMagic, sizeof(kMagic));
+        writeU64(out, old.size);
+        out.write(old.hash.data(), static_cast<std::streamsize>(old.hash.size()));
+        std::streampos newInfoPos = out.tellp();
+        writeU64(out, 0);
+        out.write(std::string(kHashBytes, '\0').data(), kHashBytes);
+
+        DeltaWriter writer(out);
+        ResHasher newHasher;
+        std::uint64_t newPos = 0;
+        std::int64_t displacement = 0;     // old offset - new offset of the last matched chunk
+        std::vector<char> oldBytes;
+        bool readFailed = false;
+
+        std::uint64_t newSize = splitContentDefined(
+            [&newIn](char* data, std::size_t size) {
+                newIn.read(data, static_cast<std::streamsize>(size));
+                return static_cast<std::size_t>(newIn.gcount());
+            },
+            kIoBlockBytes,
+            [&](const char* data, std::size_t size) {
+                newHasher.update(data, size);
+
+                std::string key = chunkKey(data, size);
+                auto found = old.offsets.find(key);
+                if (found != old.offsets.end())
+                {
+                    writer.ref(key, found->second, size);
+                    displacement = static_cast<std::int64_t>(found->second) - static_cast<std::int64_t>(newPos);
+                    newPos += size;
+                    return;
+                }
+
+                // a changed chunk: compare with the old bytes where it would be if
+                // nothing around it moved, copying the stretches that still match
+                std::int64_t base = static_cast<std::int64_t>(newPos) + displacement;
+                std::size_t available = 0;
+                if (base >= 0 && static_cast<std::uint64_t>(base) < old.size)
+                {
+                    available = static_cast<std::size_t>(std::min<std::uint64_t>(size, old.size - static_cast<std::uint64_t>(base)));
+                    oldBytes.resize(available);
+                    if (!readAt(oldIn, static_cast<std::uint64_t>(base), oldBytes.data(), available))
+                    {
+                        readFailed = true;
+                        available = 0;
+                    }
+                }
+
+                std::size_t i = 0;
+                while (i < size)
+                {
+                    std::size_t j = i;
+                    while (j < available && data[j] == oldBytes[j])
+                        ++j;
+
+                    if (j - i >= kMinCopyBytes)
+                    {
+                        writer.copy(static_cast<std::uint64_t>(base) + i, j - i);
+                        i = j;
+                        continue;
+                    }
+
+                    std::size_t end = std::max(j, i + 1);
+                    writer.data(data + i, end - i);
+                    i = end;
+                }
+
+                newPos += size;
+            });
+
+        writer.flush();
+        out.put(static_cast<char>(kOpEnd));
+
+        std::uint64_t deltaSize = static_cast<std::uint64_t>(out.tellp());
+        out.seekp(newInfoPos);
+        writeU64(out, newSize);
+        std::string newHash = hexToBytes(newHasher.hexDigest());
+        out.write(newHash.data(), static_cast<std::streamsize>(newHash.size()));
+
+        if (readFailed || newIn.bad() || !out)
+        {
+            mLog.error() << "Error: failed to write delta: " << mDeltaFile;
+            return false;
+        }
+
+        mLog.info() << "Delta written: " << mDeltaFile << " (" << deltaSize << " bytes for " << newSize << ")";
+        mLog.info() << "  " << writer.refBytes << " bytes referenced by chunk hash, " << writer.copyBytes
+                    << " copied from changed chunks, " << writer.dataBytes << " new";
+        return true;
+    }
+
+    //──────────────────────────────
+    // Delta application
+    //──────────────────────────────
+    bool ResDeltaApplier::validateInputs() const
+    {
+        if (mOldFile.empty() || mDeltaFile.empty() || mOutputFile.empty())
+        {
+            mLog.error() << "Error: old file, delta file and output file must be set.";
+            return false;
+        }
+
+        for (const auto& path : { mOldFile, mDeltaFile })
+        {
+            if (!fs::is_regular_file(path))
+            {
+                mLog.error() << "Error: file does not exist: " << path;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool ResDeltaApplier::run()
+    {
+        if (!validateInputs())
+            return false;
+
+        std::ifstream delta(mDeltaFile, std::ios::binary);
+        char magic[sizeof(kMagic)];
+        std::uint64_t expectedOldSize = 0, expectedNewSize = 0;
+        std::string expectedOldHash(kHashBytes, '\0'), expectedNewHash(kHashBytes, '\0');
+
+        bool headerOk = delta.read(magic, sizeof(magic)) && std::equal(magic, magic + sizeof(magic), kMagic) &&
+                        readU64(delta, expectedOldSize) && delta.read(expectedOldHash.data(), kHashBytes) &&
+                        readU64(delta, expectedNewSize) && delta.read(expectedNewHash.data(), kHashBytes);
+        if (!headerOk)
+        {
+            mLog.error() << "Error: not a resman-lite delta: " << mDeltaFile;
+            return false;
+        }
+
+        ChunkIndex old;
+        if (!indexFile(mOldFile, old))
+        {
+            mLog.error() << "Error: failed to read file: " << mOldFile;
+            return false;
+        }
+
+        if (old.size != expectedOldSize || old.hash != expectedOldHash)
+        {
+            mLog.error() << "Error: " << mOldFile << " is not the file the delta " << mDeltaFile << " was made from";
+            return false;
+        }
+
+        std::string staged = mOutputFile + ".resman-tmp";
+        std::ifstream oldIn(mOldFile, std::ios::binary);
+        std::ofstream out(staged, std::ios::binary | std::ios::trunc);
+        if (!oldIn || !out)
+        {
+            mLog.error() << "Error: failed to open " << mOldFile << " or " << staged;
+            return false;
+        }
+
+        ResHasher hasher;
+        std::uint64_t written = 0;
+        std::vector<char> buffer(kIoBlockBytes);
+
+        auto copyOld = [&](std::uint64_t offset, std::uint64_t size) {
+            if (offset > old.size || size > old.size - offset)
+                return false;
+
+            while (size)
+            {
+                std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(size, buffer.size()));
+                if (!readAt(oldIn, offset, buffer.data(), count))
+                    return false;
+                out.write(buffer.data(), static_cast<std::streamsize>(count));
+                hasher.update(buffer.data(), count);
+                offset += count;
+                size -= count;
+                written += count;
+            }
+            return true;
+        };
+
+        bool ok = true;
+        bool done = false;
+        while (ok && !done)
+        {
+            int op = delta.get();
+            std::uint64_t offset = 0, size = 0;
+            switch (op)
+            {
+            case kOpEnd:
+                done = true;
+                break;
+
+            case kOpRef:
+            {
+                std::string key(kChunkKeyBytes, '\0');
+                ok = delta.read(key.data(), kChunkKeyBytes) && readU64(delta, size);
+                auto found = ok ? old.offsets.find(key) : old.offsets.end();
+                ok = ok && found != old.offsets.end() && copyOld(found->second, size);
+                break;
+            }
+
+            case kOpCopy:
+                ok = readU64(delta, offset) && readU64(delta, size) && copyOld(offset, size);
+                break;
+
+            case kOpData:
+                ok = readU64(delta, size);
+                while (ok && size)
+                {
+                    std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(size, buffer.size()));
+                    ok = static_cast<bool>(delta.read(buffer.data(), static_cast<std::streamsize>(count)));
+                    out.write(buffer.data(), static_cast<std::streamsize>(count));
+                    hasher.update(buffer.data(), count);
+                    size -= count;
+                    written += count;
+                }
+                break;
+
+            default:
+                ok = false;
+                break;
+            }
+        }
+
+        out.close();
+        std::error_code ec;
+        if (!ok || !out)
+        {
+            mLog.error() << "Error: corrupt or truncated delta: " << mDeltaFile;
+            fs::remove(staged, ec);
+            return false;
+        }
+
+        if (written != expectedNewSize || hexToBytes(hasher.hexDigest()) != expectedNewHash)
+        {
+            mLog.error() << "Error: applying " << mDeltaFile << " did not reproduce the new file (hash mismatch)";
+            fs::remove(staged, ec);
+            return false;
+        }
+
+        fs::rename(staged, mOutputFile, ec);
+        if (ec)
+        {
+            mLog.error() << "Error: failed to replace " << mOutputFile << ": " << ec.message();
+            fs::remove(staged, ec);
+            return false;
+        }
+
+        mLog.info() << "Delta applied: " << mOutputFile << " (" << written << " bytes)";
+        return true;
+    }
+
+} // namespace resman
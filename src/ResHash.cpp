@@ -0,0 +1,149 @@
+#include "ResHash.h"
+#include <fstream>
+#include <vector>
+
+namespace resman
+{
+    static const uint32_t kRoundConstants[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+
+    static inline uint32_t rotr(uint32_t x, unsigned n)
+    {
+        return (x >> n) | (x << (32 - n));
+    }
+
+    ResHasher::ResHasher()
+        : mState{ 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 }
+    {
+    }
+
+    void ResHasher::processBlock(const unsigned char* block)
+    {
+        uint32_t w[64];
+        for (int i = 0; i < 16; ++i)
+        {
+            w[i] = (uint32_t(block[i * 4]) << 24) | (uint32_t(block[i * 4 + 1]) << 16) |
+                   (uint32_t(block[i * 4 + 2]) << 8) | uint32_t(block[i * 4 + 3]);
+        }
+        for (int i = 16; i < 64; ++i)
+        {
+            uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = mState[0], b = mState[1], c = mState[2], d = mState[3];
+        uint32_t e = mState[4], f = mState[5], g = mState[6], h = mState[7];
+
+        for (int i = 0; i < 64; ++i)
+        {
+            uint32_t S1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+            uint32_t ch = (e & f) ^ (~e & g);
+            uint32_t t1 = h + S1 + ch + kRoundConstants[i] + w[i];
+            uint32_t S0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+            uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+            uint32_t t2 = S0 + maj;
+
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+
+        mState[0] += a; mState[1] += b; mState[2] += c; mState[3] += d;
+        mState[4] += e; mState[5] += f; mState[6] += g; mState[7] += h;
+    }
+
+    ResHasher& ResHasher::update(const void* data, std::size_t size)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        mTotalLen += size;
+
+        if (mBufferLen > 0)
+        {
+            while (size > 0 && mBufferLen < 64)
+            {
+                mBuffer[mBufferLen++] = *bytes++;
+                --size;
+            }
+            if (mBufferLen < 64)
+                return *this;
+
+            processBlock(mBuffer);
+            mBufferLen = 0;
+        }
+
+        for (; size >= 64; size -= 64, bytes += 64)
+            processBlock(bytes);
+
+        for (; size > 0; --size)
+            mBuffer[mBufferLen++] = *bytes++;
+
+        return *this;
+    }
+
+    ResHasher& ResHasher::update(const std::string& data)
+    {
+        return update(data.data(), data.size());
+    }
+
+    ResHasher& ResHasher::updateField(const std::string& field)
+    {
+        uint64_t len = field.size();
+        unsigned char lenBytes[8];
+        for (int i = 0; i < 8; ++i)
+            lenBytes[i] = static_cast<unsigned char>(len >> (8 * i));
+
+        update(lenBytes, sizeof(lenBytes));
+        return update(field);
+    }
+
+    std::string ResHasher::hexDigest()
+    {
+        uint64_t bitLen = mTotalLen * 8;
+
+        unsigned char pad[72] = { 0x80 };
+        std::size_t padLen = (mBufferLen < 56) ? (56 - mBufferLen) : (120 - mBufferLen);
+        for (int i = 0; i < 8; ++i)
+            pad[padLen + i] = static_cast<unsigned char>(bitLen >> (56 - 8 * i));
+        update(pad, padLen + 8);
+
+        static const char* hexChars = "0123456789abcdef";
+        std::string hex;
+        hex.reserve(64);
+        for (uint32_t word : mState)
+        {
+            for (int shift = 28; shift >= 0; shift -= 4)
+                hex.push_back(hexChars[(word >> shift) & 0xf]);
+        }
+        return hex;
+    }
+
+    std::optional<std::string> ResHasher::hashFile(const std::string& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+            return std::nullopt;
+
+        ResHasher hasher;
+        std::vector<char> buffer(1 << 16);
+        while (in)
+        {
+            in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            hasher.update(buffer.data(), static_cast<std::size_t>(in.gcount()));
+        }
+        return hasher.hexDigest();
+    }
+
+    std::string ResHasher::hashString(const std::string& data)
+    {
+        return ResHasher().update(data).hexDigest();
+    }
+
+} // namespace resman
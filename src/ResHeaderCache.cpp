@@ -0,0 +1,229 @@
+#include "ResHeaderCache.h"
+#include "ResHash.h"
+#include "ResToolVersion.h"
+
+#include <fstream>
+#include <filesystem>
+#include <random>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace resman
+{
+    //──────────────────────────────
+    // Setters
+    //──────────────────────────────
+    ResHeaderCache& ResHeaderCache::setCacheDir(const std::string& dir)
+    {
+        mCacheDir = dir;
+        mKey.clear();
+        return *this;
+    }
+
+    ResHeaderCache& ResHeaderCache::setWorkingDir(const std::string& dir)
+    {
+        mWorkingDir = dir;
+        return *this;
+    }
+
+    ResHeaderCache& ResHeaderCache::setClangPath(const std::string& path)
+    {
+        mClangPath = path;
+        mKey.clear();
+        return *this;
+    }
+
+    ResHeaderCache& ResHeaderCache::setHeaderFile(const std::string& path)
+    {
+        mHeaderFile = path;
+        mKey.clear();
+        return *this;
+    }
+
+    ResHeaderCache& ResHeaderCache::addIncludePath(const std::string& includeDir)
+    {
+        mIncludeDirs.push_back(includeDir);
+        mKey.clear();
+        return *this;
+    }
+
+    ResHeaderCache& ResHeaderCache::addIncludePath(const std::vector<std::string>& includeDir)
+    {
+        mIncludeDirs.insert(mIncludeDirs.end(), includeDir.begin(), includeDir.end());
+        mKey.clear();
+        return *this;
+    }
+
+    ResHeaderCache& ResHeaderCache::addDefine(const std::string& define)
+    {
+        mDefines.push_back(define);
+        mKey.clear();
+        return *this;
+    }
+
+    ResHeaderCache& ResHeaderCache::addDefine(const std::vector<std::string>& define)
+    {
+        mDefines.insert(mDefines.end(), define.begin(), define.end());
+        mKey.clear();
+        return *this;
+    }
+
+    ResHeaderCache& ResHeaderCache::setLogCallback(LogCallback callback)
+    {
+        mLog.setCallback(std::move(callback));
+        return *this;
+    }
+
+    //──────────────────────────────
+    // Helpers
+    //──────────────────────────────
+    bool ResHeaderCache::validateInputs() const
+    {
+        if (mCacheDir.empty()) {
+            mLog.error() << "Error: cache directory not set.";
+            return false;
+        }
+
+        if (mHeaderFile.empty() || !fs::exists(mHeaderFile)) {
+            mLog.error() << "Error: header file invalid: " << mHeaderFile;
+            return false;
+        }
+
+        return true;
+    }
+
+    std::string ResHeaderCache::queryClangVersion() const
+    {
+        return queryToolVersion(mClangPath.empty() ? "clang++" : mClangPath, mWorkingDir);
+    }
+
+    std::string ResHeaderCache::computeKey()
+    {
+        if (!mKey.empty())
+            return mKey;
+
+        auto headerHash = ResHasher::hashFile(mHeaderFile);
+        std::string clangVersion = queryClangVersion();
+        if (!headerHash || clangVersion.empty())
+            return "";
+
+        ResHasher hasher;
+        hasher.updateField("resman-lite header cache v1")
+              .updateField(fs::absolute(mHeaderFile).lexically_normal().string())
+              .updateField(*headerHash)
+              .updateField(clangVersion);
+
+        hasher.updateField(std::to_string(mIncludeDirs.size()));
+        for (const auto& inc : mIncludeDirs)
+            hasher.updateField(inc);
+
+        hasher.updateField(std::to_string(mDefines.size()));
+        for (const auto& d : mDefines)
+            hasher.updateField(d);
+
+        mKey = hasher.hexDigest();
+        return mKey;
+    }
+
+    std::string ResHeaderCache::entryPath()
+    {
+        std::string key = computeKey();
+        if (key.empty())
+            return "";
+
+        return (fs::path(mCacheDir) / "headers" / (key + ".json")).string();
+    }
+
+    //──────────────────────────────
+    // Lookup / Store
+    //──────────────────────────────
+    bool ResHeaderCache::lookup(std::vector<ResourceInfo>& resources)
+    {
+        if (!validateInputs())
+            return false;
+
+        std::string path = entryPath();
+        if (path.empty() || !fs::exists(path))
+            return false;
+
+        json entry;
+        try {
+            std::ifstream in(path);
+            in >> entry;
+
+            // any changed (or vanished) dependency invalidates the entry
+            std::vector<std::string> depPaths;
+            for (const auto& dep : entry.at("dependencies")) {
+                depPaths.push_back(dep.at("path").get<std::string>());
+                auto hash = ResHasher::hashFile(depPaths.back());
+                if (!hash || *hash != dep.at("hash").get<std::string>())
+                    return false;
+            }
+
+            resources = entry.at("resources").get<std::vector<ResourceInfo>>();
+            mDependencies = std::move(depPaths);
+        }
+        catch (const std::exception& e) {
+            mLog.warning() << "Warning: ignoring unreadable cache entry " << path << ": " << e.what();
+            return false;
+        }
+
+        mLog.info() << "Cache hit for " << mHeaderFile << " (" << resources.size() << " resources)";
+        return true;
+    }
+
+    bool ResHeaderCache::store(const std::vector<ResourceInfo>& resources, const std::vector<std::string>& dependencies)
+    {
+        if (!validateInputs())
+            return false;
+
+        std::string path = entryPath();
+        if (path.empty()) {
+            mLog.warning() << "Warning: could not compute cache key, result not cached.";
+            return false;
+        }
+
+        json deps = json::array();
+        for (const auto& dep : dependencies) {
+            auto hash = ResHasher::hashFile(dep);
+            if (!hash) {
+                mLog.warning() << "Warning: cannot hash dependency " << dep << ", result not cached.";
+                return false;
+            }
+            deps.push_back({ {"path", fs::absolute(dep).lexically_normal().string()}, {"hash", *hash} });
+        }
+
+        json entry = {
+            {"header", mHeaderFile},
+            {"dependencies", deps},
+            {"resources", resources}
+        };
+
+        // write-then-rename, so concurrent builds never see a half-written entry
+        std::error_code ec;
+        fs::create_directories(fs::path(path).parent_path(), ec);
+
+        std::random_device rd;
+        std::string tmpPath = path + ".tmp" + std::to_string(rd());
+        {
+            std::ofstream out(tmpPath);
+            if (!out) {
+                mLog.warning() << "Warning: failed to write cache entry " << tmpPath;
+                return false;
+            }
+            out << entry.dump(4);
+        }
+
+        fs::rename(tmpPath, path, ec);
+        if (ec) {
+            fs::remove(tmpPath, ec);
+            mLog.warning() << "Warning: failed to store cache entry " << path;
+            return false;
+        }
+
+        mLog.info() << "Cached header parse result: " << path;
+        return true;
+    }
+
+} // namespace resman
@@ -1,9 +1,10 @@
 #include "ResHeaderParser.h"
 
-#include <iostream>
 #include <sstream>
+#include <fstream>
 #include <filesystem>
 #include <cstdlib>
+#include <cctype>
 
 namespace fs = std::filesystem;
 
@@ -27,6 +28,12 @@ namespace resman
         return *this;
     }
 
+    ResHeaderParser& ResHeaderParser::setDepFile(const std::string& path)
+    {
+        mDepFile = path;
+        return *this;
+    }
+
     ResHeaderParser& ResHeaderParser::addIncludePath(const std::string& includeDir)
     {
         mIncludeDirs.push_back(includeDir);
@@ -51,20 +58,26 @@ namespace resman
         return *this;
     }
 
+    ResHeaderParser& ResHeaderParser::setLogCallback(LogCallback callback)
+    {
+        mLog.setCallback(std::move(callback));
+        return *this;
+    }
+
     bool ResHeaderParser::validateInputs() const
     {
         if (mHeaderFile.empty()) {
-            std::cerr << "[ResHeaderParser] Error: header file not set.\n";
+            mLog.error() << "Error: header file not set.";
             return false;
         }
 
         if (!fs::exists(mHeaderFile)) {
-            std::cerr << "[ResHeaderParser] Error: header file does not exist: " << mHeaderFile << "\n";
+            mLog.error() << "Error: header file does not exist: " << mHeaderFile;
             return false;
         }
 
         if (mOutputJson.empty()) {
-            std::cerr << "[ResHeaderParser] Error: output JSON path not set.\n";
+            mLog.error() << "Error: output JSON path not set.";
             return false;
         }
 
@@ -98,6 +111,14 @@ namespace resman
                 cmd << "-D" << d << " ";
         }
 
+        // dependency output, so callers know which files the AST depends on
+        if (!mDepFile.empty()) {
+            if (mDepFile.find(' ') != std::string::npos)
+                cmd << "-MD -MF \"" << mDepFile << "\" ";
+            else
+                cmd << "-MD -MF " << mDepFile << " ";
+        }
+
         // input file (quote if needed)
         if (mHeaderFile.find(' ') != std::string::npos)
             cmd << "\"" << mHeaderFile << "\" ";
@@ -118,25 +139,81 @@ namespace resman
     {
         std::string cmd = getCommandLine();
 
-        std::cout << "[ResHeaderParser] Invoking: " << cmd << "\n";
+        mLog.info() << "Invoking: " << cmd;
 
         // Execute command
         int rc = std::system(cmd.c_str());
 
         if (rc != 0) {
-            std::cerr << "[ResHeaderParser] clang returned non-zero exit code: " << rc << "\n";
+            mLog.error() << "clang returned non-zero exit code: " << rc;
             return false;
         }
 
         // Verify output file was created
         if (!fs::exists(mOutputJson)) {
-            std::cerr << "[ResHeaderParser] Error: Expected output file not found: " << mOutputJson << "\n";
+            mLog.error() << "Error: Expected output file not found: " << mOutputJson;
             return false;
         }
 
         return true;
     }
 
+    std::vector<std::string> ResHeaderParser::parseDepFile(const std::string& path)
+    {
+        std::vector<std::string> deps;
+
+        std::ifstream in(path);
+        if (!in)
+            return deps;
+
+        std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+        // skip the "target:" part; a drive letter colon ("C:\") is followed by a slash
+        size_t pos = 0;
+        while ((pos = content.find(':', pos)) != std::string::npos) {
+            if (pos + 1 < content.size() && (content[pos + 1] == '\\' || content[pos + 1] == '/')) {
+                ++pos;
+                continue;
+            }
+            ++pos;
+            break;
+        }
+        if (pos == std::string::npos)
+            return deps;
+
+        std::string current;
+        for (size_t i = pos; i < content.size(); ++i) {
+            char c = content[i];
+            if (c == '\\' && i + 1 < content.size()) {
+                char next = content[i + 1];
+                if (next == ' ' || next == '#') {        // escaped character in a path
+                    current.push_back(next);
+                    ++i;
+                    continue;
+                }
+                if (next == '\n' || next == '\r') {     // line continuation
+                    continue;
+                }
+            }
+            if (c == '$' && i + 1 < content.size() && content[i + 1] == '$') {
+                current.push_back('$');
+                ++i;
+                continue;
+            }
+            if (std::isspace(static_cast<unsigned char>(c))) {
+                if (!current.empty())
+                    deps.push_back(current);
+                current.clear();
+                continue;
+            }
+            current.push_back(c);
+        }
+        if (!current.empty())
+            deps.push_back(current);
+
+        return deps;
+    }
+
     bool ResHeaderParser::run()
     {
         if (!validateInputs())
@@ -146,10 +223,17 @@ namespace resman
         // but keep it simple and just attempt to run.
         bool ok = invokeClangAST();
         if (!ok) {
-            std::cerr << "[ResHeaderParser] Error: AST generation failed.\n";
+            mLog.error() << "Error: AST generation failed.";
             return false;
         }
 
+        mDependencies.clear();
+        if (!mDepFile.empty()) {
+            mDependencies = parseDepFile(mDepFile);
+            if (mDependencies.empty())
+                mDependencies.push_back(mHeaderFile);
+        }
+
         return true;
     }
 
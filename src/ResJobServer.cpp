@@ -0,0 +1,214 @@
+#include "ResJobServer.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <cerrno>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace resman
+{
+    //──────────────────────────────
+    // Token
+    //──────────────────────────────
+    ResJobServer::Token::Token(Token&& other) noexcept
+        : mServer(other.mServer), mKind(other.mKind), mByte(other.mByte)
+    {
+        other.mKind = Kind::None;
+    }
+
+    ResJobServer::Token& ResJobServer::Token::operator=(Token&& other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            mServer = other.mServer;
+            mKind = other.mKind;
+            mByte = other.mByte;
+            other.mKind = Kind::None;
+        }
+        return *this;
+    }
+
+    ResJobServer::Token::~Token()
+    {
+        release();
+    }
+
+    void ResJobServer::Token::release()
+    {
+        if (mKind == Kind::Implicit)
+            mServer->mImplicitTaken.store(false);
+        else if (mKind == Kind::Shared)
+            mServer->writeToken(mByte);
+        mKind = Kind::None;
+    }
+
+    //──────────────────────────────
+    // Setup
+    //──────────────────────────────
+    ResJobServer& ResJobServer::instance()
+    {
+        static ResJobServer server;
+        return server;
+    }
+
+    ResJobServer::ResJobServer()
+    {
+        const char* makeflags = std::getenv("MAKEFLAGS");
+        if (!makeflags)
+            return;
+
+        // the last option wins, as in make itself
+        std::string auth;
+        std::istringstream words(makeflags);
+        std::string word;
+        while (words >> word)
+        {
+            for (const char* prefix : { "--jobserver-auth=", "--jobserver-fds=" })
+            {
+                if (word.compare(0, std::strlen(prefix), prefix) == 0)
+                    auth = word.substr(std::strlen(prefix));
+            }
+        }
+
+        if (!auth.empty())
+            mActive = connect(auth);
+    }
+
+    ResJobServer::~ResJobServer()
+    {
+#if defined(_WIN32)
+        if (mSemaphore)
+            CloseHandle(static_cast<HANDLE>(mSemaphore));
+#else
+        if (mOwnsFds)
+        {
+            close(mReadFd);
+            if (mWriteFd != mReadFd)
+                close(mWriteFd);
+        }
+#endif
+    }
+
+    bool ResJobServer::connect(const std::string& auth)
+    {
+#if defined(_WIN32)
+        mSemaphore = OpenSemaphoreA(SEMAPHORE_MODIFY_STATE | SYNCHRONIZE, FALSE, auth.c_str());
+        if (!mSemaphore)
+            return false;
+
+        mDescription = "semaphore " + auth;
+        return true;
+#else
+        if (auth.compare(0, 5, "fifo:") == 0)
+        {
+            std::string path = auth.substr(5);
+            mReadFd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+            if (mReadFd < 0)
+                return false;
+
+            mWriteFd = mReadFd;
+            mOwnsFds = true;
+            mDescription = "fifo " + path;
+            return true;
+        }
+
+        // R,W: descriptors inherited from make, unless the recipe wasn't marked
+        // as recursive (+) and make closed them. Then the numbers may have been
+        // reused for files of this process; only pipes are taken for tokens.
+        int readFd = -1;
+        int writeFd = -1;
+        char comma = 0;
+        std::istringstream fds(auth);
+        if (!(fds >> readFd >> comma >> writeFd) || comma != ',' || readFd < 0 || writeFd < 0)
+            return false;
+
+        auto isPipe = [](int fd) {
+            struct stat info;
+            return fstat(fd, &info) == 0 && S_ISFIFO(info.st_mode);
+        };
+        if (!isPipe(readFd) || !isPipe(writeFd))
+            return false;
+
+        mReadFd = readFd;
+        mWriteFd = writeFd;
+        mDescription = "pipe " + auth;
+        return true;
+#endif
+    }
+
+    //──────────────────────────────
+    // Tokens
+    //──────────────────────────────
+    bool ResJobServer::readToken(char& byte)
+    {
+#if defined(_WIN32)
+        byte = '+';
+        return WaitForSingleObject(static_cast<HANDLE>(mSemaphore), INFINITE) == WAIT_OBJECT_0;
+#else
+        while (true)
+        {
+            ssize_t n = read(mReadFd, &byte, 1);
+            if (n == 1)
+                return true;
+
+            if (n < 0 && errno == EINTR)
+                continue;
+
+            // make may have left the pipe non-blocking
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                pollfd pfd{ mReadFd, POLLIN, 0 };
+                poll(&pfd, 1, -1);
+                continue;
+            }
+
+            return false;
+        }
+#endif
+    }
+
+    void ResJobServer::writeToken(char byte)
+    {
+#if defined(_WIN32)
+        (void)byte;
+        ReleaseSemaphore(static_cast<HANDLE>(mSemaphore), 1, nullptr);
+#else
+        while (write(mWriteFd, &byte, 1) < 0 && errno == EINTR)
+        {
+        }
+#endif
+    }
+
+    ResJobServer::Token ResJobServer::acquire()
+    {
+        if (!mActive)
+            return {};
+
+        if (!mImplicitTaken.exchange(true))
+            return Token(this, Token::Kind::Implicit, '+');
+
+        char byte = '+';
+        if (!readToken(byte))
+        {
+            // a broken jobserver shouldn't fail the build; run unthrottled
+            mActive = false;
+            return {};
+        }
+
+        return Token(this, Token::Kind::Shared, byte);
+    }
+
+} // namespace resman
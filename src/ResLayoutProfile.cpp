@@ -0,0 +1,113 @@
+#include "ResLayoutProfile.h"
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+namespace resman
+{
+    //──────────────────────────────
+    // Setters
+    //──────────────────────────────
+    ResLayoutProfile& ResLayoutProfile::addProfile(const std::string& path)
+    {
+        if (!path.empty())
+            mProfilePaths.push_back(path);
+        return *this;
+    }
+
+    ResLayoutProfile& ResLayoutProfile::setLogCallback(LogCallback callback)
+    {
+        mLog.setCallback(std::move(callback));
+        return *this;
+    }
+
+    //──────────────────────────────
+    // Loading
+    //──────────────────────────────
+    // "<id> <first_access> <count> <first_access_us>" per line, '#' comments
+    bool ResLayoutProfile::loadProfile(const std::string& path)
+    {
+        std::ifstream in(path);
+        if (!in)
+        {
+            mLog.error() << "Error: failed to open layout profile: " << path;
+            return false;
+        }
+
+        struct Access
+        {
+            unsigned id;
+            unsigned long long firstAccess;
+            unsigned long long count;
+        };
+
+        std::vector<Access> accesses;
+        std::string line;
+        while (std::getline(in, line))
+        {
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            std::istringstream fields(line);
+            Access access{};
+            if (!(fields >> access.id >> access.firstAccess >> access.count))
+            {
+                mLog.warning() << "Warning: skipping malformed line in " << path << ": " << line;
+                continue;
+            }
+            accesses.push_back(access);
+        }
+
+        std::sort(accesses.begin(), accesses.end(),
+                  [](const Access& a, const Access& b) { return a.firstAccess < b.firstAccess; });
+
+        for (size_t i = 0; i < accesses.size(); ++i)
+        {
+            Usage& usage = mUsage[accesses[i].id];
+            usage.rankSum += static_cast<double>(i) / static_cast<double>(accesses.size());
+            usage.profiles++;
+            usage.count += accesses[i].count;
+        }
+
+        mLog.info() << "Layout profile " << path << ": " << accesses.size() << " accessed resources";
+        return true;
+    }
+
+    bool ResLayoutProfile::load()
+    {
+        mUsage.clear();
+        for (const auto& path : mProfilePaths)
+        {
+            if (!loadProfile(path))
+                return false;
+        }
+        return true;
+    }
+
+    //──────────────────────────────
+    // Ordering
+    //──────────────────────────────
+    std::vector<unsigned> ResLayoutProfile::order(const std::vector<unsigned>& ids) const
+    {
+        std::vector<unsigned> hot;
+        std::vector<unsigned> cold;
+        for (unsigned id : ids)
+            (mUsage.count(id) ? hot : cold).push_back(id);
+
+        // earliest average first access first; more frequently used on ties
+        std::stable_sort(hot.begin(), hot.end(), [this](unsigned a, unsigned b) {
+            const Usage& ua = mUsage.at(a);
+            const Usage& ub = mUsage.at(b);
+            double ra = ua.rankSum / ua.profiles;
+            double rb = ub.rankSum / ub.profiles;
+            if (ra != rb)
+                return ra < rb;
+            return ua.count > ub.count;
+        });
+
+        hot.insert(hot.end(), cold.begin(), cold.end());
+        return hot;
+    }
+
+} // namespace resman
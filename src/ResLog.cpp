@@ -0,0 +1,25 @@
+#include "ResLog.h"
+#include <iostream>
+#include <mutex>
+
+namespace resman
+{
+    void defaultLogCallback(LogLevel level, const std::string& component, const std::string& message)
+    {
+        // keep lines from concurrent steps from interleaving
+        static std::mutex outputMutex;
+        std::lock_guard<std::mutex> lock(outputMutex);
+
+        std::ostream& out = (level == LogLevel::Info) ? std::cout : std::cerr;
+        out << "[" << component << "] " << message << "\n";
+    }
+
+    void ResLogger::log(LogLevel level, const std::string& message) const
+    {
+        if (mCallback)
+            mCallback(level, mComponent, message);
+        else
+            defaultLogCallback(level, mComponent, message);
+    }
+
+} // namespace resman
@@ -1,9 +1,18 @@
 #include "ResObjGenerator.h"
-#include <iostream>
+#include "ResHash.h"
+#include "ResToolVersion.h"
+#include "ResJobServer.h"
 #include <sstream>
 #include <fstream>
 #include <filesystem>
 #include <cstdlib>
+#include <future>
+#include <algorithm>
+#include <map>
+#include <limits>
+#include <cstring>
+#include <cctype>
+#include <optional>
 
 namespace fs = std::filesystem;
 
@@ -36,6 +45,12 @@ namespace resman
         return *this;
     }
 
+    ResObjGenerator& ResObjGenerator::setLlvmArPath(const std::string& path)
+    {
+        mLlvmArPath = path;
+        return *this;
+    }
+
     ResObjGenerator& ResObjGenerator::setInputCppDir(const std::string& dir)
     {
         mInputCppDir = dir;
@@ -56,7 +71,53 @@ namespace resman
 
     ResObjGenerator& ResObjGenerator::setTargetTriple(const std::string& triple)
     {
-        mTargetTriple = triple;
+        mTargetTriples.clear();
+        return addTargetTriple(triple);
+    }
+
+    ResObjGenerator& ResObjGenerator::addTargetTriple(const std::string& triple)
+    {
+        if (!triple.empty())
+            mTargetTriples.push_back(triple);
+
+        return *this;
+    }
+
+    ResObjGenerator& ResObjGenerator::addTargetTriple(const std::vector<std::string>& triples)
+    {
+        for (const auto& t : triples)
+            addTargetTriple(t);
+
+        return *this;
+    }
+
+    ResObjGenerator& ResObjGenerator::setWriteIfChanged(bool enable)
+    {
+        mWriteIfChanged = enable;
+        return *this;
+    }
+
+    ResObjGenerator& ResObjGenerator::setOutputKind(ObjOutputKind kind)
+    {
+        mOutputKind = kind;
+        return *this;
+    }
+
+    ResObjGenerator& ResObjGenerator::setCppFileOrder(const std::vector<std::string>& cppFiles)
+    {
+        mCppFileOrder = cppFiles;
+        return *this;
+    }
+
+    ResObjGenerator& ResObjGenerator::setObjectCacheDir(const std::string& dir)
+    {
+        mObjectCache.setCacheDir(dir);
+        return *this;
+    }
+
+    ResObjGenerator& ResObjGenerator::setObjectCacheMaxBytes(std::uint64_t bytes)
+    {
+        mObjectCache.setMaxBytes(bytes);
         return *this;
     }
 
@@ -77,18 +138,25 @@ namespace resman
         return *this;
     }
 
+    ResObjGenerator& ResObjGenerator::setLogCallback(LogCallback callback)
+    {
+        mObjectCache.setLogCallback(callback);
+        mLog.setCallback(std::move(callback));
+        return *this;
+    }
+
     //──────────────────────────────
     // Helpers
     //──────────────────────────────
     bool ResObjGenerator::validateInputs() const
     {
         if (mInputCppDir.empty() || !fs::exists(mInputCppDir)) {
-            std::cerr << "[ResObjGenerator] Error: input .cpp directory invalid: " << mInputCppDir << "\n";
+            mLog.error() << "Error: input .cpp directory invalid: " << mInputCppDir;
             return false;
         }
 
         if (mWorkingDir.empty()) {
-            std::cerr << "[ResObjGenerator] Error: working directory not set.\n";
+            mLog.error() << "Error: working directory not set.";
             return false;
         }
 
@@ -96,7 +164,7 @@ namespace resman
             fs::create_directories(mWorkingDir);
 
         if (mOutputObj.empty()) {
-            std::cerr << "[ResObjGenerator] Error: output object path not set.\n";
+            mLog.error() << "Error: output object path not set.";
             return false;
         }
 
@@ -104,6 +172,49 @@ namespace resman
         return true;
     }
 
+    static bool naturalLess(const std::string& a, const std::string& b)
+    {
+        auto isDigit = [](char ch) { return ch >= '0' && ch <= '9'; };
+
+        size_t i = 0, j = 0;
+        while (i < a.size() && j < b.size())
+        {
+            if (isDigit(a[i]) && isDigit(b[j]))
+            {
+                size_t endA = i, endB = j;
+                while (endA < a.size() && isDigit(a[endA]))
+                    ++endA;
+                while (endB < b.size() && isDigit(b[endB]))
+                    ++endB;
+
+                // leading zeros aside, the longer run is the larger number
+                size_t startA = i, startB = j;
+                while (startA + 1 < endA && a[startA] == '0')
+                    ++startA;
+                while (startB + 1 < endB && b[startB] == '0')
+                    ++startB;
+                if (endA - startA != endB - startB)
+                    return endA - startA < endB - startB;
+
+                int cmp = a.compare(startA, endA - startA, b, startB, endB - startB);
+                if (cmp != 0)
+                    return cmp < 0;
+
+                i = endA;
+                j = endB;
+                continue;
+            }
+
+            if (a[i] != b[j])
+                return a[i] < b[j];
+            ++i;
+            ++j;
+        }
+
+        // equal by value: fall back to plain order so the sort stays strict
+        return (a.size() - i < b.size() - j) || (a.size() - i == b.size() - j && a < b);
+    }
+
     std::vector<std::string> ResObjGenerator::collectCppFiles() const
     {
         std::vector<std::string> cppFiles;
@@ -113,8 +224,26 @@ namespace resman
                 cppFiles.push_back(entry.path().string());
         }
 
+        // directory order differs between file systems; keep link order stable,
+        // with numbers compared by value (resman_lite_res2 before resman_lite_res10)
+        std::sort(cppFiles.begin(), cppFiles.end(), naturalLess);
+
+        if (!mCppFileOrder.empty())
+        {
+            std::map<std::string, size_t> rank;
+            for (size_t i = 0; i < mCppFileOrder.size(); ++i)
+                rank.emplace(fs::path(mCppFileOrder[i]).filename().string(), i);
+
+            auto rankOf = [&](const std::string& cpp) {
+                auto it = rank.find(fs::path(cpp).filename().string());
+                return it != rank.end() ? it->second : rank.size();
+            };
+            std::stable_sort(cppFiles.begin(), cppFiles.end(),
+                             [&](const std::string& a, const std::string& b) { return rankOf(a) < rankOf(b); });
+        }
+
         if (cppFiles.empty())
-            std::cerr << "[ResObjGenerator] Warning: no .cpp files found in " << mInputCppDir << "\n";
+            mLog.warning() << "Warning: no .cpp files found in " << mInputCppDir;
 
         return cppFiles;
     }
@@ -128,112 +257,817 @@ namespace resman
 
     bool ResObjGenerator::invokeCmd(const std::string& cmd, const std::string& stepDesc) const
     {
-        std::cout << "[ResObjGenerator] " << stepDesc << ":\n  " << cmd << "\n";
+        // held until the subprocess exits
+        auto token = ResJobServer::instance().acquire();
+
+        mLog.info() << stepDesc << ":\n  " << cmd;
         int rc = std::system(cmd.c_str());
         if (rc != 0)
         {
-            std::cerr << "[ResObjGenerator] Error: command failed (" << rc << "): " << stepDesc << "\n";
+            mLog.error() << "Error: command failed (" << rc << "): " << stepDesc;
             return false;
         }
         return true;
     }
 
+    std::string ResObjGenerator::getOutputObjPath(const std::string& triple) const
+    {
+        if (mTargetTriples.size() <= 1 || triple.empty())
+            return mOutputObj;
+
+        // resources.o -> resources.x86_64-unknown-linux-gnu.o
+        fs::path out(mOutputObj);
+        fs::path name = out.stem().string() + "." + triple + out.extension().string();
+        return (out.parent_path() / name).string();
+    }
+
+    // A module holding only constant data can be retargeted by llc as long as
+    // symbol mangling, pointer width and (for the module-level assembly of
+    // chunked resources) object format agree. Modules that define functions
+    // (the registry's constructor) are compiled per triple, see compileGroupModule().
+    static std::string frontendKey(const std::string& triple)
+    {
+        auto has = [&](const char* s) { return triple.find(s) != std::string::npos; };
+
+        bool msvcAbi = has("msvc") ||
+                       ((has("windows") || has("win32")) && !has("gnu") && !has("cygnus") && !has("itanium"));
+
+        std::string arch = triple.substr(0, triple.find('-'));
+        bool is64 = arch.find("64") != std::string::npos || arch == "s390x" || arch == "sparcv9";
+        if (arch == "arm64_32" || arch == "aarch64_32" || (arch == "x86_64" && has("gnux32")))
+            is64 = false;
+
+        std::string format = "elf";
+        if (has("apple") || has("darwin") || has("macos") || has("ios"))
+            format = "macho";
+        else if (has("windows") || has("win32") || has("mingw") || has("cygwin"))
+            format = "coff";
+
+        return std::string(msvcAbi ? "msvc" : "itanium") + (is64 ? "-64-" : "-32-") + format;
+    }
+
+    std::vector<ResObjGenerator::FrontendGroup> ResObjGenerator::groupTargetTriples() const
+    {
+        std::vector<FrontendGroup> groups;
+        std::vector<std::string> keys;
+
+        if (mTargetTriples.empty())
+        {
+            // host triple, decided by clang and llc
+            groups.push_back({ "", { "" }, mWorkingDir });
+            return groups;
+        }
+
+        for (const auto& triple : mTargetTriples)
+        {
+            // bitcode outputs keep their own triple, nothing is retargeted by llc
+            std::string key = (mOutputKind == ObjOutputKind::Object) ? frontendKey(triple) : triple;
+            size_t idx = 0;
+            while (idx < keys.size() && keys[idx] != key)
+                ++idx;
+
+            if (idx == keys.size())
+            {
+                keys.push_back(key);
+                groups.push_back({ triple, {}, mWorkingDir });
+            }
+            groups[idx].targetTriples.push_back(triple);
+        }
+
+        // keep intermediates of different IR flavours apart
+        if (groups.size() > 1)
+        {
+            for (size_t i = 0; i < groups.size(); ++i)
+            {
+                groups[i].workingDir = (fs::path(mWorkingDir) / keys[i]).string();
+                fs::create_directories(groups[i].workingDir);
+            }
+        }
+
+        return groups;
+    }
+
     //──────────────────────────────
     // Core Generation
     //──────────────────────────────
-    bool ResObjGenerator::generateObjectFile() const
+    // Compiles a module for a group. Code keeps the frontend's CPU, features
+    // and ABI lowering, so a module that defines functions is compiled again
+    // for every other triple of the group; its data-only neighbours are shared.
+    bool ResObjGenerator::compileGroupModule(const std::string& cppFile, const std::string& moduleKey,
+                                             const FrontendGroup& group, CompiledModule& module) const
     {
-        auto cppFiles = collectCppFiles();
-        if (cppFiles.empty())
+        module.cacheKey = moduleKey;
+        module.tripleBcFiles.clear();
+
+        bool definesFunctions = false;
+        if (!compileBitcodeModule(cppFile, moduleKey, group, module.bcFile, definesFunctions))
             return false;
 
-        std::vector<std::string> bcFiles;
+        if (group.targetTriples.size() <= 1 || !definesFunctions)
+            return true;
 
+        mLog.info() << "Module with code, compiled per target triple: " << fs::path(cppFile).filename().string();
+        module.tripleBcFiles.push_back(module.bcFile);
+        for (size_t t = 1; t < group.targetTriples.size(); ++t)
+        {
+            const std::string& triple = group.targetTriples[t];
+            FrontendGroup exact{ triple, { triple }, (fs::path(group.workingDir) / triple).string() };
+            fs::create_directories(exact.workingDir);
+
+            std::string bcFile;
+            bool unused = false;
+            if (!compileBitcodeModule(cppFile, moduleCacheKey(cppFile, exact), exact, bcFile, unused))
+                return false;
+            module.tripleBcFiles.push_back(bcFile);
+        }
+        return true;
+    }
+
+    bool ResObjGenerator::compileBitcodeModule(const std::string& cppFile, const std::string& moduleKey,
+                                               const FrontendGroup& group, std::string& bcFile,
+                                               bool& definesFunctions) const
+    {
         std::string clangBin   = mClangPath.empty()   ? "clang++"   : mClangPath;
         std::string llvmAsBin  = mLlvmAsPath.empty()  ? "llvm-as"   : mLlvmAsPath;
-        std::string llvmLinkBin= mLlvmLinkPath.empty()? "llvm-link" : mLlvmLinkPath;
-        std::string llcBin     = mLlcPath.empty()     ? "llc"       : mLlcPath;
+        bool thinLto = (mOutputKind == ObjOutputKind::ThinBitcode);
+
+        // .cpp → .ll → .bc, or straight to ThinLTO bitcode (llvm-as can't add the module summary)
+        fs::path stem = fs::path(cppFile).stem();
+        fs::path llFile = fs::path(group.workingDir) / (stem.string() + ".ll");
+        bcFile = (fs::path(group.workingDir) / (stem.string() + ".bc")).string();
+
+        // shared modules are only cached when data-only, so a hit never has code
+        definesFunctions = false;
+        if (mObjectCache.fetch(moduleKey, bcFile))
+            return true;
 
-        // .cpp → .ll → .bc
-        for (const auto& cpp : cppFiles)
+        // both go through textual IR, whose source file name is made independent
+        // of the working dir: a module's bitcode only depends on its source
+        std::ostringstream clangCmd;
+        clangCmd << quote(clangBin) << " -S -emit-llvm ";
+
+        if (!group.frontendTriple.empty())
+            clangCmd << "--target=" << group.frontendTriple << " ";
+
+        // append include directories
+        for (const auto& inc : mIncludePaths)
         {
-            fs::path stem = fs::path(cpp).stem();
-            fs::path llFile = fs::path(mWorkingDir) / (stem.string() + ".ll");
-            fs::path bcFile = fs::path(mWorkingDir) / (stem.string() + ".bc");
+            if (inc.find(' ') != std::string::npos)
+                clangCmd << "-I\"" << inc << "\" ";
+            else
+                clangCmd << "-I" << inc << " ";
+        }
 
-            std::ostringstream clangCmd;
-            clangCmd << quote(clangBin)
-                    << " -S -emit-llvm ";
+        clangCmd << quote(cppFile)
+                << " -o " << quote(llFile.string());
 
-            if (!mTargetTriple.empty())
-                clangCmd << "--target=" << mTargetTriple << " ";
+        if (!invokeCmd(clangCmd.str(), "Generating LLVM IR (.ll)"))
+            return false;
 
-            // append include directories
-            for (const auto& inc : mIncludePaths)
-            {
-                if (inc.find(' ') != std::string::npos)
-                    clangCmd << "-I\"" << inc << "\" ";
-                else
-                    clangCmd << "-I" << inc << " ";
-            }
+        if (!normalizeModuleSource(llFile.string(), fs::path(cppFile).filename().string()))
+            return false;
 
-            clangCmd << quote(cpp)
-                    << " -o " << quote(llFile.string());
+        bool shared = group.targetTriples.size() > 1;
+        if (shared && !prepareSharedModule(llFile.string(), definesFunctions))
+            return false;
+        std::string cacheKey = definesFunctions ? "" : moduleKey;
 
-            if (!mTargetTriple.empty())
-                clangCmd << " --target=" << mTargetTriple;
+        if (thinLto)
+        {
+            // clang compiles IR input too, adding the module summary
+            std::ostringstream thinCmd;
+            thinCmd << quote(clangBin) << " -c -flto=thin "
+                    << quote(llFile.string()) << " -o " << quote(bcFile);
 
-            if (!invokeCmd(clangCmd.str(), "Generating LLVM IR (.ll)"))
+            if (!invokeCmd(thinCmd.str(), "Generating ThinLTO bitcode (.bc)"))
                 return false;
 
-            std::ostringstream asCmd;
-            asCmd << quote(llvmAsBin)
-                  << " " << quote(llFile.string())
-                  << " -o " << quote(bcFile.string());
+            mObjectCache.store(cacheKey, bcFile);
+            return true;
+        }
 
-            if (!invokeCmd(asCmd.str(), "Assembling LLVM bitcode (.bc)"))
-                return false;
+        std::ostringstream asCmd;
+        asCmd << quote(llvmAsBin)
+              << " " << quote(llFile.string())
+              << " -o " << quote(bcFile);
+
+        if (!invokeCmd(asCmd.str(), "Assembling LLVM bitcode (.bc)"))
+            return false;
+
+        mObjectCache.store(cacheKey, bcFile);
+        return true;
+    }
 
-            bcFiles.push_back(bcFile.string());
+    // clang names the module after the source path it was given, a path in the
+    // (often temporary) working dir; the name ends up in the bitcode. It is
+    // replaced by the file name in place: the "; ModuleID" comment line before
+    // it is padded to keep the size, so nothing after it has to be copied.
+    bool ResObjGenerator::normalizeModuleSource(const std::string& llFile, const std::string& sourceName) const
+    {
+        std::fstream ll(llFile, std::ios::in | std::ios::out | std::ios::binary);
+        if (!ll)
+        {
+            mLog.error() << "Error: failed to open: " << llFile;
+            return false;
+        }
+
+        std::string head(4096, '\0');
+        ll.read(head.data(), static_cast<std::streamsize>(head.size()));
+        head.resize(static_cast<size_t>(ll.gcount()));
+        ll.clear();
+
+        const std::string moduleIdKey = "; ModuleID = ";
+        const std::string sourceKey = "\nsource_filename = ";
+        size_t sourcePos = head.find(sourceKey);
+        size_t sourceEnd = sourcePos == std::string::npos ? std::string::npos : head.find('\n', sourcePos + 1);
+        if (head.compare(0, moduleIdKey.size(), moduleIdKey) != 0 || sourceEnd == std::string::npos)
+        {
+            mLog.warning() << "Warning: unexpected IR header, module name left as is: " << llFile;
+            return true;
         }
 
+        // line breaks are kept as they are (CRLF on Windows)
+        if (head[sourceEnd - 1] == '\r')
+            --sourceEnd;
+        size_t moduleIdEnd = sourcePos;
+        if (moduleIdEnd > 0 && head[moduleIdEnd - 1] == '\r')
+            --moduleIdEnd;
+        std::string lineBreak = head.substr(moduleIdEnd, sourcePos + 1 - moduleIdEnd);
+
+        std::string moduleId = moduleIdKey + "'" + sourceName + "'";
+        std::string source = "source_filename = \"" + sourceName + "\"";
+        size_t available = sourceEnd - lineBreak.size();
+        if (moduleId.size() + source.size() > available)
+        {
+            mLog.warning() << "Warning: module name left as is: " << llFile;
+            return true;
+        }
+
+        moduleId.append(available - moduleId.size() - source.size(), ' ');
+        std::string replacement = moduleId + lineBreak + source;
+
+        ll.seekp(0);
+        ll.write(replacement.data(), static_cast<std::streamsize>(replacement.size()));
+        if (!ll)
+        {
+            mLog.error() << "Error: failed to write: " << llFile;
+            return false;
+        }
+        return true;
+    }
+
+    // A module shared by several triples: tells whether it defines functions,
+    // and blanks what ties it to the frontend's triple in place (with spaces,
+    // so nothing moves). Without a target triple and data layout, llvm-link
+    // takes them from the modules compiled per triple and llc from -mtriple;
+    // target-cpu, tune-cpu and target-features would not be recognized for
+    // the other triples. Only line heads are read; data lines can be huge.
+    bool ResObjGenerator::prepareSharedModule(const std::string& llFile, bool& definesFunctions) const
+    {
+        std::fstream ll(llFile, std::ios::in | std::ios::out | std::ios::binary);
+        if (!ll)
+        {
+            mLog.error() << "Error: failed to open: " << llFile;
+            return false;
+        }
+
+        static const char* const targetAttributes[] = { "\"target-cpu\"=\"", "\"tune-cpu\"=\"", "\"target-features\"=\"" };
+        const std::string defineKey = "define ";
+        const std::string targetKey = "target ";
+        const std::string attributesKey = "attributes #";
+
+        definesFunctions = false;
+        char head[16];
+        while (ll.peek() != std::char_traits<char>::eof())
+        {
+            std::streamoff lineStart = ll.tellg();
+            ll.get(head, sizeof(head), '\n');     // fails on an empty line
+            std::string prefix(head, static_cast<size_t>(ll.gcount()));
+            ll.clear();
+
+            if (prefix.compare(0, defineKey.size(), defineKey) == 0)
+                definesFunctions = true;
+
+            bool target = prefix.compare(0, targetKey.size(), targetKey) == 0;
+            if (!target && prefix.compare(0, attributesKey.size(), attributesKey) != 0)
+            {
+                ll.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                continue;
+            }
+
+            std::string line;
+            ll.seekg(lineStart);
+            std::getline(ll, line);
+            std::streamoff next = lineStart + static_cast<std::streamoff>(line.size()) + 1;
+
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            std::string blanked = target ? std::string(line.size(), ' ') : line;
+            for (const char* key : targetAttributes)
+            {
+                for (size_t pos = blanked.find(key); pos != std::string::npos; pos = blanked.find(key, pos))
+                {
+                    size_t end = blanked.find('"', pos + std::strlen(key));
+                    if (end == std::string::npos)
+                        break;
+                    blanked.replace(pos, end + 1 - pos, end + 1 - pos, ' ');
+                }
+            }
+
+            if (blanked != line)
+            {
+                ll.clear();
+                ll.seekp(lineStart);
+                ll.write(blanked.data(), static_cast<std::streamsize>(blanked.size()));
+                ll.seekg(next);
+            }
+        }
+
+        if (ll.bad())
+        {
+            mLog.error() << "Error: failed to update: " << llFile;
+            return false;
+        }
+        return true;
+    }
+
+    bool ResObjGenerator::linkBitcodeModules(const std::vector<std::string>& bcFiles, const FrontendGroup& group,
+                                             std::string& mergedBC) const
+    {
+        std::string llvmLinkBin= mLlvmLinkPath.empty()? "llvm-link" : mLlvmLinkPath;
+
         // link all .bc → all.bc
-        fs::path mergedBC = fs::path(mWorkingDir) / "resman_lite_master_bit_code_file.bc";
+        mergedBC = (fs::path(group.workingDir) / "resman_lite_master_bit_code_file.bc").string();
 
         std::ostringstream linkCmd;
         linkCmd << quote(llvmLinkBin) << " ";
         for (const auto& bc : bcFiles)
             linkCmd << quote(bc) << " ";
-        linkCmd << "-o " << quote(mergedBC.string());
+        linkCmd << "-o " << quote(mergedBC);
+
+        return invokeCmd(linkCmd.str(), "Linking all .bc files");
+    }
 
-        if (!invokeCmd(linkCmd.str(), "Linking all .bc files"))
+    static bool filesEqual(const fs::path& a, const fs::path& b)
+    {
+        std::error_code ec;
+        if (!fs::exists(a, ec) || !fs::exists(b, ec) || fs::file_size(a, ec) != fs::file_size(b, ec))
             return false;
 
+        std::ifstream inA(a, std::ios::binary), inB(b, std::ios::binary);
+        if (!inA || !inB)
+            return false;
+
+        std::vector<char> bufA(1 << 16), bufB(1 << 16);
+        while (inA && inB)
+        {
+            inA.read(bufA.data(), static_cast<std::streamsize>(bufA.size()));
+            inB.read(bufB.data(), static_cast<std::streamsize>(bufB.size()));
+            if (inA.gcount() != inB.gcount() ||
+                !std::equal(bufA.begin(), bufA.begin() + inA.gcount(), bufB.begin()))
+                return false;
+        }
+        return true;
+    }
+
+    // with write-if-changed, outputs are produced next to their final path and
+    // only moved over it when the contents differ
+    std::string ResObjGenerator::stagingPath(const std::string& outputPath) const
+    {
+        return mWriteIfChanged ? outputPath + ".resman-tmp" : outputPath;
+    }
+
+    bool ResObjGenerator::commitOutput(const std::string& stagedPath, const std::string& outputPath) const
+    {
+        if (stagedPath != outputPath)
+        {
+            std::error_code ec;
+            if (filesEqual(stagedPath, outputPath))
+            {
+                fs::remove(stagedPath, ec);
+                mLog.info() << "Unchanged, kept existing: " << outputPath;
+                return true;
+            }
+
+            fs::rename(stagedPath, outputPath, ec);
+            if (ec)
+            {
+                mLog.error() << "Error: failed to replace " << outputPath << ": " << ec.message();
+                return false;
+            }
+        }
+
+        mLog.info() << "Successfully generated: " << outputPath;
+        return true;
+    }
+
+    bool ResObjGenerator::emitObject(const std::string& mergedBC, const std::string& triple, const std::string& cacheKey) const
+    {
+        std::string llcBin = mLlcPath.empty() ? "llc" : mLlcPath;
+        std::string outputObj = getOutputObjPath(triple);
+        std::string llcOutput = stagingPath(outputObj);
+
         // all.bc → .obj
         std::ostringstream llcCmd;
         llcCmd << quote(llcBin)
-               << " -filetype=obj " << quote(mergedBC.string())
-               << " -o " << quote(mOutputObj);
+               << " -filetype=obj " << quote(mergedBC)
+               << " -o " << quote(llcOutput);
 
-        if (!mTargetTriple.empty())
-            llcCmd << " -mtriple=" << mTargetTriple;
+        if (!triple.empty())
+            llcCmd << " -mtriple=" << triple;
 
         if (!invokeCmd(llcCmd.str(), "Generating final object (.obj/.o)"))
             return false;
 
-        std::cout << "[ResObjGenerator] Successfully generated: " << mOutputObj << "\n";
-        return true;
+        mObjectCache.store(cacheKey, llcOutput);
+        return commitOutput(llcOutput, outputObj);
+    }
+
+    bool ResObjGenerator::emitBitcode(const std::string& mergedBC, const std::string& triple, const std::string& cacheKey) const
+    {
+        std::string outputBC = getOutputObjPath(triple);
+        std::string staged = stagingPath(outputBC);
+
+        std::error_code ec;
+        fs::copy_file(mergedBC, staged, fs::copy_options::overwrite_existing, ec);
+        if (ec)
+        {
+            mLog.error() << "Error: failed to write " << staged << ": " << ec.message();
+            return false;
+        }
+
+        mObjectCache.store(cacheKey, staged);
+        return commitOutput(staged, outputBC);
+    }
+
+    bool ResObjGenerator::emitBitcodeArchive(const std::vector<std::string>& bcFiles, const std::string& triple,
+                                             const std::string& cacheKey) const
+    {
+        std::string llvmArBin = mLlvmArPath.empty() ? "llvm-ar" : mLlvmArPath;
+        std::string outputLib = getOutputObjPath(triple);
+        std::string staged = stagingPath(outputLib);
+
+        // "r" would add to a previous archive
+        std::error_code ec;
+        fs::remove(staged, ec);
+
+        std::ostringstream arCmd;
+        arCmd << quote(llvmArBin) << " rcs " << quote(staged);
+        for (const auto& bc : bcFiles)
+            arCmd << " " << quote(bc);
+
+        if (!invokeCmd(arCmd.str(), "Archiving ThinLTO bitcode modules"))
+            return false;
+
+        mObjectCache.store(cacheKey, staged);
+        return commitOutput(staged, outputLib);
+    }
+
+    //──────────────────────────────
+    // Object Cache
+    //──────────────────────────────
+    // The generated sources only include the runtime headers (resman.h and,
+    // depending on the mode, resman_dev.h etc.), so their content (rather
+    // than the project-specific include paths) goes into the module keys
+    std::string ResObjGenerator::runtimeHeaderHash() const
+    {
+        for (const auto& inc : mIncludePaths)
+        {
+            if (!fs::exists(fs::path(inc) / "resman.h"))
+                continue;
+
+            std::vector<fs::path> headers;
+            std::error_code ec;
+            for (const auto& entry : fs::directory_iterator(inc, ec))
+            {
+                std::string name = entry.path().filename().string();
+                if (name.compare(0, 6, "resman") == 0 && entry.path().extension() == ".h")
+                    headers.push_back(entry.path());
+            }
+            std::sort(headers.begin(), headers.end());
+
+            ResHasher hasher;
+            for (const auto& header : headers)
+            {
+                hasher.updateField(header.filename().string())
+                      .updateField(ResHasher::hashFile(header.string()).value_or(""));
+            }
+            return hasher.hexDigest();
+        }
+
+        ResHasher hasher;
+        for (const auto& inc : mIncludePaths)
+            hasher.updateField(inc);
+        return hasher.hexDigest();
+    }
+
+    // The path of an .incbin directive as ResCppSrcGenerator writes it: octal
+    // escapes of the C string literal, then the assembler's \\ and \"
+    static std::string unescapeIncbinPath(const std::string& escaped)
+    {
+        std::string asmText;
+        for (size_t i = 0; i < escaped.size(); ++i)
+        {
+            if (escaped[i] == '\\' && i + 3 < escaped.size() && std::isdigit(static_cast<unsigned char>(escaped[i + 1])))
+            {
+                asmText += static_cast<char>(((escaped[i + 1] - '0') << 6) | ((escaped[i + 2] - '0') << 3) | (escaped[i + 3] - '0'));
+                i += 3;
+            }
+            else
+                asmText += escaped[i];
+        }
+
+        std::string path;
+        for (size_t i = 0; i < asmText.size(); ++i)
+        {
+            if (asmText[i] == '\\' && i + 1 < asmText.size())
+                ++i;
+            path += asmText[i];
+        }
+        return path;
+    }
+
+    // Chunked resources and blobs are .incbin'd from outside the source. Each
+    // included file goes into the hash by its content rather than its path,
+    // so the key doesn't change with the (often temporary) dir it was written to.
+    static std::optional<std::string> hashIncbinSource(const std::string& cppFile)
+    {
+        std::ifstream in(cppFile, std::ios::binary);
+        if (!in)
+            return std::nullopt;
+
+        const std::string directive = ".incbin \\\"";
+        const std::string quote = "\\\"";
+        ResHasher hasher;
+        std::string line;
+        while (std::getline(in, line))
+        {
+            size_t start = line.find(directive);
+            size_t end = start == std::string::npos ? std::string::npos : line.find(quote, start + directive.size());
+            if (end == std::string::npos)
+            {
+                hasher.updateField(line);
+                continue;
+            }
+
+            size_t pathStart = start + directive.size();
+            auto fileHash = ResHasher::hashFile(unescapeIncbinPath(line.substr(pathStart, end - pathStart)));
+            if (!fileHash)
+                return std::nullopt;
+
+            hasher.updateField(line.substr(0, start))
+                  .updateField(*fileHash)
+                  .updateField(line.substr(end));
+        }
+
+        if (in.bad())
+            return std::nullopt;
+        return hasher.hexDigest();
+    }
+
+    std::string ResObjGenerator::moduleCacheKey(const std::string& cppFile, const FrontendGroup& group) const
+    {
+        if (!mObjectCache.enabled())
+            return "";
+
+        // the directives of .incbin'd data come first
+        bool incbin = false;
+        {
+            std::ifstream in(cppFile, std::ios::binary);
+            std::string head(1 << 16, '\0');
+            in.read(head.data(), static_cast<std::streamsize>(head.size()));
+            head.resize(static_cast<size_t>(in.gcount()));
+            incbin = head.find(".incbin") != std::string::npos;
+        }
+
+        bool thinLto = (mOutputKind == ObjOutputKind::ThinBitcode);
+        auto sourceHash = incbin ? hashIncbinSource(cppFile) : ResHasher::hashFile(cppFile);
+        if (!sourceHash)
+            mLog.warning() << "Warning: failed to hash, not cached: " << cppFile;
+        std::string clangVersion = queryToolVersion(mClangPath.empty() ? "clang++" : mClangPath, mWorkingDir);
+        std::string llvmAsVersion = thinLto ? "" : queryToolVersion(mLlvmAsPath.empty() ? "llvm-as" : mLlvmAsPath, mWorkingDir);
+        if (!sourceHash || clangVersion.empty() || (!thinLto && llvmAsVersion.empty()))
+            return "";
+
+        ResHasher hasher;
+        hasher.updateField("resman-lite object cache v3")
+              .updateField(thinLto ? "thin-bc" : "bc")
+              .updateField(group.frontendTriple)
+              .updateField(group.targetTriples.size() > 1 ? "shared" : "")
+              .updateField(*sourceHash)
+              .updateField(mRuntimeHeaderHash)
+              .updateField(clangVersion)
+              .updateField(llvmAsVersion);
+        return hasher.hexDigest();
+    }
+
+    std::string ResObjGenerator::outputCacheKey(const std::vector<std::string>& moduleKeys, const std::string& triple) const
+    {
+        if (!mObjectCache.enabled())
+            return "";
+
+        ResHasher hasher;
+        hasher.updateField("resman-lite object cache v3").updateField(triple);
+
+        std::vector<std::string> tools;
+        switch (mOutputKind)
+        {
+        case ObjOutputKind::Object:
+            hasher.updateField("obj");
+            tools = { mLlvmLinkPath.empty() ? "llvm-link" : mLlvmLinkPath, mLlcPath.empty() ? "llc" : mLlcPath };
+            break;
+        case ObjOutputKind::Bitcode:
+            hasher.updateField("bc");
+            tools = { mLlvmLinkPath.empty() ? "llvm-link" : mLlvmLinkPath };
+            break;
+        case ObjOutputKind::ThinBitcode:
+            hasher.updateField("thin-bc");
+            tools = { mLlvmArPath.empty() ? "llvm-ar" : mLlvmArPath };
+            break;
+        }
+
+        for (const auto& tool : tools)
+        {
+            std::string version = queryToolVersion(tool, mWorkingDir);
+            if (version.empty())
+                return "";
+            hasher.updateField(version);
+        }
+
+        hasher.updateField(std::to_string(moduleKeys.size()));
+        for (const auto& key : moduleKeys)
+        {
+            if (key.empty())
+                return "";
+            hasher.updateField(key);
+        }
+
+        return hasher.hexDigest();
+    }
+
+    bool ResObjGenerator::restoreOutput(const std::string& cacheKey, const std::string& triple) const
+    {
+        std::string outputPath = getOutputObjPath(triple);
+        std::string staged = stagingPath(outputPath);
+
+        return mObjectCache.fetch(cacheKey, staged) && commitOutput(staged, outputPath);
+    }
+
+    const ResObjGenerator::CompiledModule* ResObjGenerator::findCompiledModule(const std::string& cppFile,
+                                                                                size_t groupIndex) const
+    {
+        std::lock_guard<std::mutex> lock(mCompiledMutex);
+        auto it = mCompiledModules.find(fs::path(cppFile).filename().string());
+        return it != mCompiledModules.end() ? &it->second[groupIndex] : nullptr;
+    }
+
+    bool ResObjGenerator::generateObjectFile() const
+    {
+        auto cppFiles = collectCppFiles();
+        if (cppFiles.empty())
+            return false;
+
+        // Front end and bitcode link run once per IR flavour (and the link once
+        // per triple when a module has code), then every target triple gets
+        // its own llc run, all of them concurrently. Modules already built by
+        // compileModule() are reused as they are.
+        std::vector<std::future<bool>> jobs;
+        for (size_t g = 0; g < mGroups.size(); ++g)
+        {
+            const auto& group = mGroups[g];
+
+            std::vector<std::string> moduleKeys;
+            for (const auto& cpp : cppFiles)
+            {
+                const CompiledModule* compiled = findCompiledModule(cpp, g);
+                moduleKeys.push_back(compiled ? compiled->cacheKey : moduleCacheKey(cpp, group));
+            }
+
+            // outputs already in the object cache skip the whole group
+            std::vector<std::pair<std::string, std::string>> pending;   // triple, output key
+            for (const auto& triple : group.targetTriples)
+            {
+                std::string key = outputCacheKey(moduleKeys, triple);
+                if (!restoreOutput(key, triple))
+                    pending.emplace_back(triple, key);
+            }
+
+            if (pending.empty())
+                continue;
+
+            std::vector<CompiledModule> modules(cppFiles.size());
+            bool perTriple = false;
+            for (size_t i = 0; i < cppFiles.size(); ++i)
+            {
+                if (const CompiledModule* compiled = findCompiledModule(cppFiles[i], g))
+                    modules[i] = *compiled;
+                else if (!compileGroupModule(cppFiles[i], moduleKeys[i], group, modules[i]))
+                    return false;
+                perTriple = perTriple || !modules[i].tripleBcFiles.empty();
+            }
+
+            std::vector<std::string> bcFiles;
+            for (const auto& module : modules)
+                bcFiles.push_back(module.bcFile);
+
+            // bitcode groups hold exactly one triple
+            if (mOutputKind == ObjOutputKind::ThinBitcode)
+            {
+                if (!emitBitcodeArchive(bcFiles, pending.front().first, pending.front().second))
+                    return false;
+                continue;
+            }
+
+            std::string mergedBC;
+            if (!perTriple)
+            {
+                if (!linkBitcodeModules(bcFiles, group, mergedBC))
+                    return false;
+            }
+
+            if (mOutputKind == ObjOutputKind::Bitcode)
+            {
+                if (!emitBitcode(mergedBC, pending.front().first, pending.front().second))
+                    return false;
+                continue;
+            }
+
+            for (const auto& [triple, key] : pending)
+            {
+                // modules with code were compiled for each triple, so each gets its own link
+                if (perTriple)
+                {
+                    size_t t = static_cast<size_t>(std::find(group.targetTriples.begin(), group.targetTriples.end(), triple) -
+                                                   group.targetTriples.begin());
+                    FrontendGroup exact{ triple, { triple }, (fs::path(group.workingDir) / triple).string() };
+                    fs::create_directories(exact.workingDir);
+
+                    std::vector<std::string> tripleBcFiles;
+                    for (const auto& module : modules)
+                        tripleBcFiles.push_back(module.tripleBcFiles.empty() ? module.bcFile : module.tripleBcFiles[t]);
+                    if (!linkBitcodeModules(tripleBcFiles, exact, mergedBC))
+                        return false;
+                }
+
+                jobs.push_back(std::async(std::launch::async, &ResObjGenerator::emitObject, this, mergedBC, triple, key));
+            }
+        }
+
+        bool ok = true;
+        for (auto& job : jobs)
+            ok = job.get() && ok;
+
+        mObjectCache.trim();
+        return ok;
     }
 
     //──────────────────────────────
     // Entry Point
     //──────────────────────────────
-    bool ResObjGenerator::run()
+    bool ResObjGenerator::beginBuild()
     {
         if (!validateInputs())
             return false;
 
-        return generateObjectFile();
+        if (ResJobServer::instance().active())
+            mLog.info() << "Sharing job slots with the make jobserver (" << ResJobServer::instance().description() << ")";
+
+        mGroups = groupTargetTriples();
+        mRuntimeHeaderHash = mObjectCache.enabled() ? runtimeHeaderHash() : "";
+        std::lock_guard<std::mutex> lock(mCompiledMutex);
+        mCompiledModules.clear();
+        return true;
+    }
+
+    bool ResObjGenerator::compileModule(const std::string& cppFile)
+    {
+        std::vector<CompiledModule> modules(mGroups.size());
+        for (size_t g = 0; g < mGroups.size(); ++g)
+        {
+            if (!compileGroupModule(cppFile, moduleCacheKey(cppFile, mGroups[g]), mGroups[g], modules[g]))
+                return false;
+        }
+
+        std::lock_guard<std::mutex> lock(mCompiledMutex);
+        mCompiledModules[fs::path(cppFile).filename().string()] = std::move(modules);
+        return true;
+    }
+
+    bool ResObjGenerator::finishBuild()
+    {
+        bool ok = generateObjectFile();
+
+        std::lock_guard<std::mutex> lock(mCompiledMutex);
+        mCompiledModules.clear();
+        return ok;
+    }
+
+    bool ResObjGenerator::run()
+    {
+        if (!beginBuild())
+            return false;
+
+        return finishBuild();
     }
 
 } // namespace resman
\ No newline at end of file
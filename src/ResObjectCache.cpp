@@ -0,0 +1,156 @@
+#include "ResObjectCache.h"
+
+#include <filesystem>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+namespace fs = std::filesystem;
+
+namespace resman
+{
+    //──────────────────────────────
+    // Setters
+    //──────────────────────────────
+    ResObjectCache& ResObjectCache::setCacheDir(const std::string& dir)
+    {
+        mCacheDir = dir;
+        return *this;
+    }
+
+    ResObjectCache& ResObjectCache::setMaxBytes(std::uint64_t bytes)
+    {
+        mMaxBytes = bytes;
+        return *this;
+    }
+
+    ResObjectCache& ResObjectCache::setLogCallback(LogCallback callback)
+    {
+        mLog.setCallback(std::move(callback));
+        return *this;
+    }
+
+    //──────────────────────────────
+    // Helpers
+    //──────────────────────────────
+    // <cache>/ab/abcdef..., so no single directory gets too large
+    std::string ResObjectCache::entryPath(const std::string& key) const
+    {
+        return (fs::path(mCacheDir) / key.substr(0, 2) / key).string();
+    }
+
+    //──────────────────────────────
+    // Fetch / Store
+    //──────────────────────────────
+    bool ResObjectCache::fetch(const std::string& key, const std::string& destPath) const
+    {
+        if (!enabled() || key.empty())
+            return false;
+
+        std::string path = entryPath(key);
+
+        // an entry evicted by a concurrent trim() simply becomes a miss
+        std::error_code ec;
+        fs::copy_file(path, destPath, fs::copy_options::overwrite_existing, ec);
+        if (ec)
+            return false;
+
+        // the mtime doubles as last-use time for LRU eviction
+        fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+
+        mLog.info() << "Object cache hit: " << key << " -> " << destPath;
+        return true;
+    }
+
+    bool ResObjectCache::store(const std::string& key, const std::string& srcPath) const
+    {
+        if (!enabled() || key.empty())
+            return false;
+
+        std::string path = entryPath(key);
+
+        std::error_code ec;
+        fs::create_directories(fs::path(path).parent_path(), ec);
+
+        // write-then-rename, so concurrent builds never see a half-written entry
+        std::string tmpPath = path + ".tmp" + std::to_string(std::random_device{}());
+        fs::copy_file(srcPath, tmpPath, fs::copy_options::overwrite_existing, ec);
+        if (!ec)
+            fs::rename(tmpPath, path, ec);
+
+        if (ec)
+        {
+            fs::remove(tmpPath, ec);
+            mLog.warning() << "Warning: failed to store object cache entry " << path;
+            return false;
+        }
+
+        return true;
+    }
+
+    void ResObjectCache::trim() const
+    {
+        if (!enabled() || !fs::exists(mCacheDir))
+            return;
+
+        struct Entry
+        {
+            fs::path path;
+            fs::file_time_type lastUse;
+            std::uint64_t size;
+        };
+
+        std::vector<Entry> entries;
+        std::uint64_t total = 0;
+        auto staleTmp = fs::file_time_type::clock::now() - std::chrono::hours(24);
+
+        std::error_code ec;
+        for (auto it = fs::recursive_directory_iterator(mCacheDir, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec))
+        {
+            if (!it->is_regular_file(ec))
+                continue;
+
+            auto lastUse = it->last_write_time(ec);
+            std::uint64_t size = it->file_size(ec);
+            if (ec)
+            {
+                ec.clear();
+                continue;
+            }
+
+            // leftovers of writers that crashed before their rename
+            if (it->path().filename().string().find(".tmp") != std::string::npos)
+            {
+                if (lastUse < staleTmp)
+                    fs::remove(it->path(), ec);
+                ec.clear();
+                continue;
+            }
+
+            entries.push_back({ it->path(), lastUse, size });
+            total += size;
+        }
+
+        if (total <= mMaxBytes)
+            return;
+
+        std::sort(entries.begin(), entries.end(),
+                  [](const Entry& a, const Entry& b) { return a.lastUse < b.lastUse; });
+
+        size_t evicted = 0;
+        for (const auto& entry : entries)
+        {
+            if (total <= mMaxBytes)
+                break;
+
+            // another job may have evicted it already
+            fs::remove(entry.path, ec);
+            total -= entry.size;
+            ++evicted;
+        }
+
+        mLog.info() << "Object cache: evicted " << evicted << " entries, " << total << " bytes left";
+    }
+
+} // namespace resman
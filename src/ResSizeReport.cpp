@@ -0,0 +1,454 @@
+#include "ResSizeReport.h"
+
+#include <nlohmann/json.hpp>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <map>
+#include <optional>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace resman
+{
+    namespace
+    {
+        // "1.5 MiB"
+        std::string formatBytes(std::uint64_t bytes)
+        {
+            static const char* units[] = { "B", "KiB", "MiB", "GiB", "TiB" };
+            double value = static_cast<double>(bytes);
+            size_t unit = 0;
+            while (value >= 1024.0 && unit + 1 < sizeof(units) / sizeof(units[0]))
+            {
+                value /= 1024.0;
+                ++unit;
+            }
+
+            std::ostringstream out;
+            if (unit == 0)
+                out << bytes << " B";
+            else
+                out << std::fixed << std::setprecision(1) << value << " " << units[unit];
+            return out.str();
+        }
+
+        std::string formatDelta(std::int64_t delta)
+        {
+            std::string sign = delta < 0 ? "-" : "+";
+            return sign + formatBytes(static_cast<std::uint64_t>(delta < 0 ? -delta : delta));
+        }
+
+        // 1048576, "1048576", "1024K", "1M", "1.5G"
+        std::optional<std::uint64_t> parseByteSize(const json& value)
+        {
+            if (value.is_number_unsigned())
+                return value.get<std::uint64_t>();
+            if (!value.is_string())
+                return std::nullopt;
+
+            const std::string text = value.get<std::string>();
+            size_t end = 0;
+            double number = 0;
+            try
+            {
+                number = std::stod(text, &end);
+            }
+            catch (const std::exception&)
+            {
+                return std::nullopt;
+            }
+
+            std::string suffix = text.substr(end);
+            if (!suffix.empty() && (suffix.back() == 'B' || suffix.back() == 'b'))
+                suffix.pop_back();
+            if (suffix.size() == 2 && (suffix[1] == 'i' || suffix[1] == 'I'))
+                suffix.pop_back();
+
+            double scale = 1;
+            if (suffix == "K" || suffix == "k")
+                scale = 1024.0;
+            else if (suffix == "M" || suffix == "m")
+                scale = 1024.0 * 1024.0;
+            else if (suffix == "G" || suffix == "g")
+                scale = 1024.0 * 1024.0 * 1024.0;
+            else if (!suffix.empty())
+                return std::nullopt;
+
+            if (number < 0)
+                return std::nullopt;
+            return static_cast<std::uint64_t>(number * scale);
+        }
+
+        std::string headerLabel(const std::string& header)
+        {
+            return header.empty() ? "(resource info)" : header;
+        }
+
+        // text next to the JSON: report.json -> report.txt
+        std::string textReportPath(const std::string& jsonPath)
+        {
+            fs::path path(jsonPath);
+            if (path.extension() == ".json")
+                return path.replace_extension(".txt").string();
+            return jsonPath + ".txt";
+        }
+    }
+
+    //──────────────────────────────
+    // Setters
+    //──────────────────────────────
+    ResSizeReport& ResSizeReport::addResource(const ResourceSizeEntry& entry)
+    {
+        mResources.push_back(entry);
+        return *this;
+    }
+
+    ResSizeReport& ResSizeReport::addOutput(const std::string& path)
+    {
+        std::error_code ec;
+        auto size = fs::file_size(path, ec);
+        if (!ec)
+            mOutputs.emplace_back(path, static_cast<std::uint64_t>(size));
+        return *this;
+    }
+
+    ResSizeReport& ResSizeReport::setBaseline(const std::string& path)
+    {
+        mBaselinePath = path;
+        return *this;
+    }
+
+    ResSizeReport& ResSizeReport::setLogCallback(LogCallback callback)
+    {
+        mLog.setCallback(std::move(callback));
+        return *this;
+    }
+
+    //──────────────────────────────
+    // Aggregation
+    //──────────────────────────────
+    // Largest first; ties by id, so reports of the same build are identical
+    std::vector<ResourceSizeEntry> ResSizeReport::sortedResources() const
+    {
+        std::vector<ResourceSizeEntry> sorted = mResources;
+        std::sort(sorted.begin(), sorted.end(), [](const ResourceSizeEntry& a, const ResourceSizeEntry& b) {
+            if (a.emittedBytes != b.emittedBytes)
+                return a.emittedBytes > b.emittedBytes;
+            return a.id < b.id;
+        });
+        return sorted;
+    }
+
+    std::vector<ResSizeReport::HeaderTotal> ResSizeReport::headerTotals() const
+    {
+        std::map<std::string, HeaderTotal> byHeader;
+        for (const auto& res : mResources)
+        {
+            HeaderTotal& total = byHeader[res.header];
+            total.header = res.header;
+            total.count++;
+            total.rawBytes += res.rawBytes;
+            total.sourceBytes += res.sourceBytes;
+            total.emittedBytes += res.emittedBytes;
+        }
+
+        std::vector<HeaderTotal> totals;
+        for (auto& [header, total] : byHeader)
+            totals.push_back(total);
+
+        std::stable_sort(totals.begin(), totals.end(), [](const HeaderTotal& a, const HeaderTotal& b) {
+            return a.emittedBytes > b.emittedBytes;
+        });
+        return totals;
+    }
+
+    // Resources are matched by declared path: ids and variable names may be
+    // renumbered between builds, the file embedded rarely is
+    bool ResSizeReport::loadBaseline(std::vector<Change>& changes) const
+    {
+        std::ifstream in(mBaselinePath);
+        if (!in)
+        {
+            mLog.error() << "Error: failed to open baseline size report: " << mBaselinePath;
+            return false;
+        }
+
+        std::map<std::string, Change> byPath;
+        try
+        {
+            json baseline = json::parse(in);
+            for (const auto& res : baseline.at("resources"))
+                byPath[res.at("path").get<std::string>()].before = res.at("emitted").get<std::int64_t>();
+        }
+        catch (const std::exception& e)
+        {
+            mLog.error() << "Error: invalid baseline size report " << mBaselinePath << ": " << e.what();
+            return false;
+        }
+
+        for (const auto& res : mResources)
+            byPath[res.path].after = static_cast<std::int64_t>(res.emittedBytes);
+
+        for (auto& [path, change] : byPath)
+        {
+            if (change.before == change.after)
+                continue;
+            change.path = path;
+            changes.push_back(change);
+        }
+
+        auto magnitude = [](const Change& change) {
+            std::int64_t delta = std::max<std::int64_t>(change.after, 0) - std::max<std::int64_t>(change.before, 0);
+            return delta < 0 ? -delta : delta;
+        };
+        std::stable_sort(changes.begin(), changes.end(), [&](const Change& a, const Change& b) {
+            return magnitude(a) > magnitude(b);
+        });
+        return true;
+    }
+
+    //──────────────────────────────
+    // Output
+    //──────────────────────────────
+    bool ResSizeReport::write(const std::string& path) const
+    {
+        std::vector<ResourceSizeEntry> resources = sortedResources();
+        std::vector<HeaderTotal> headers = headerTotals();
+
+        std::vector<Change> changes;
+        if (!mBaselinePath.empty() && !loadBaseline(changes))
+            return false;
+
+        HeaderTotal total;
+        for (const auto& header : headers)
+        {
+            total.count += header.count;
+            total.rawBytes += header.rawBytes;
+            total.sourceBytes += header.sourceBytes;
+            total.emittedBytes += header.emittedBytes;
+        }
+
+        std::int64_t totalDelta = 0;
+        for (const auto& change : changes)
+            totalDelta += std::max<std::int64_t>(change.after, 0) - std::max<std::int64_t>(change.before, 0);
+
+        // JSON
+        json report;
+        report["version"] = 1;
+        report["total"] = { { "resources", total.count }, { "raw", total.rawBytes },
+                            { "source", total.sourceBytes }, { "emitted", total.emittedBytes } };
+
+        report["outputs"] = json::array();
+        for (const auto& [output, bytes] : mOutputs)
+            report["outputs"].push_back({ { "path", output }, { "bytes", bytes } });
+
+        report["headers"] = json::array();
+        for (const auto& header : headers)
+        {
+            report["headers"].push_back({ { "header", header.header }, { "resources", header.count },
+                                          { "raw", header.rawBytes }, { "source", header.sourceBytes },
+                                          { "emitted", header.emittedBytes } });
+        }
+
+        report["resources"] = json::array();
+        for (const auto& res : resources)
+        {
+            report["resources"].push_back({ { "id", res.id }, { "name", res.name }, { "header", res.header },
+                                            { "path", res.path }, { "embedded", res.embedded },
+                                            { "raw", res.rawBytes }, { "source", res.sourceBytes },
+                                            { "emitted", res.emittedBytes } });
+        }
+
+        if (!mBaselinePath.empty())
+        {
+            json diff = json::array();
+            for (const auto& change : changes)
+            {
+                diff.push_back({ { "path", change.path },
+                                 { "before", change.before < 0 ? json(nullptr) : json(change.before) },
+                                 { "after", change.after < 0 ? json(nullptr) : json(change.after) } });
+            }
+            report["baseline"] = { { "path", mBaselinePath }, { "emitted_delta", totalDelta }, { "changes", diff } };
+        }
+
+        std::ofstream jsonOut(path);
+        if (!(jsonOut << report.dump(4) << "\n"))
+        {
+            mLog.error() << "Error: failed to write size report: " << path;
+            return false;
+        }
+
+        // Text
+        std::ostringstream text;
+        text << "resman-lite size report\n\n";
+        text << "Total: " << total.count << " resources, " << formatBytes(total.rawBytes) << " raw, "
+             << formatBytes(total.sourceBytes) << " generated source, " << formatBytes(total.emittedBytes) << " emitted\n";
+        for (const auto& [output, bytes] : mOutputs)
+            text << "Output: " << output << " (" << formatBytes(bytes) << ")\n";
+
+        text << "\nBy header:\n";
+        text << std::setw(14) << "emitted" << std::setw(14) << "raw" << std::setw(14) << "source"
+             << std::setw(8) << "count" << "  header\n";
+        for (const auto& header : headers)
+        {
+            text << std::setw(14) << header.emittedBytes << std::setw(14) << header.rawBytes
+                 << std::setw(14) << header.sourceBytes << std::setw(8) << header.count
+                 << "  " << headerLabel(header.header) << "\n";
+        }
+
+        text << "\nBy resource:\n";
+        text << std::setw(14) << "emitted" << std::setw(14) << "raw" << std::setw(14) << "source"
+             << std::setw(8) << "id" << "  name (path)\n";
+        for (const auto& res : resources)
+        {
+            text << std::setw(14) << res.emittedBytes << std::setw(14) << res.rawBytes
+                 << std::setw(14) << res.sourceBytes << std::setw(8) << res.id
+                 << "  " << res.name << " (" << res.path << ")" << (res.embedded ? "" : " [not embedded]") << "\n";
+        }
+
+        if (!mBaselinePath.empty())
+        {
+            text << "\nChanges since " << mBaselinePath << ": " << formatDelta(totalDelta) << "\n";
+            for (const auto& change : changes)
+            {
+                text << std::setw(14) << formatDelta(std::max<std::int64_t>(change.after, 0) - std::max<std::int64_t>(change.before, 0))
+                     << "  " << change.path;
+                if (change.before < 0)
+                    text << " (new)";
+                else if (change.after < 0)
+                    text << " (removed)";
+                else
+                    text << " (" << change.before << " -> " << change.after << ")";
+                text << "\n";
+            }
+        }
+
+        std::string textPath = textReportPath(path);
+        std::ofstream textOut(textPath);
+        if (!(textOut << text.str()))
+        {
+            mLog.error() << "Error: failed to write size report: " << textPath;
+            return false;
+        }
+
+        mLog.info() << "Size report: " << total.count << " resources, " << formatBytes(total.emittedBytes)
+                    << " emitted (" << formatBytes(total.rawBytes) << " raw), written to " << path << " and " << textPath;
+        for (size_t i = 0; i < resources.size() && i < 5; ++i)
+        {
+            mLog.info() << "  " << formatBytes(resources[i].emittedBytes) << "  " << resources[i].name
+                        << " (" << resources[i].path << ")";
+        }
+        if (!mBaselinePath.empty())
+            mLog.info() << "  " << formatDelta(totalDelta) << " since " << mBaselinePath << ", " << changes.size() << " resources changed";
+
+        return true;
+    }
+
+    //──────────────────────────────
+    // Budgets
+    //──────────────────────────────
+    bool ResSizeReport::checkBudget(const std::string& budgetPath) const
+    {
+        std::ifstream in(budgetPath);
+        if (!in)
+        {
+            mLog.error() << "Error: failed to open size budget: " << budgetPath;
+            return false;
+        }
+
+        json budget;
+        try
+        {
+            budget = json::parse(in, nullptr, true, true);   // comments allowed
+        }
+        catch (const std::exception& e)
+        {
+            mLog.error() << "Error: invalid size budget " << budgetPath << ": " << e.what();
+            return false;
+        }
+
+        bool ok = true;
+        auto limitOf = [&](const json& value, const std::string& what) -> std::optional<std::uint64_t> {
+            auto limit = parseByteSize(value);
+            if (!limit)
+            {
+                mLog.error() << "Error: invalid size for " << what << " in " << budgetPath << ": " << value.dump();
+                ok = false;
+            }
+            return limit;
+        };
+
+        auto exceeds = [&](const std::string& what, std::uint64_t bytes, std::uint64_t limit) {
+            if (bytes <= limit)
+                return;
+            mLog.error() << "Error: size budget exceeded: " << what << " emits " << bytes << " bytes ("
+                         << formatBytes(bytes) << "), limit " << limit << " (" << formatBytes(limit) << ")";
+            ok = false;
+        };
+
+        std::uint64_t totalBytes = 0;
+        for (const auto& res : mResources)
+            totalBytes += res.emittedBytes;
+
+        if (budget.contains("total"))
+        {
+            if (auto limit = limitOf(budget["total"], "\"total\""))
+                exceeds("the build", totalBytes, *limit);
+        }
+
+        std::optional<std::uint64_t> perResource;
+        if (budget.contains("resource"))
+            perResource = limitOf(budget["resource"], "\"resource\"");
+
+        std::map<std::string, std::uint64_t> resourceLimits;
+        if (budget.contains("resources"))
+        {
+            for (const auto& [key, value] : budget["resources"].items())
+                if (auto limit = limitOf(value, "resource \"" + key + "\""))
+                    resourceLimits[key] = *limit;
+        }
+
+        for (const auto& res : mResources)
+        {
+            std::optional<std::uint64_t> limit = perResource;
+            for (const std::string& key : { res.path, res.name, std::to_string(res.id) })
+            {
+                auto it = resourceLimits.find(key);
+                if (it != resourceLimits.end())
+                {
+                    limit = it->second;
+                    break;
+                }
+            }
+
+            if (limit)
+                exceeds(res.name + " (" + res.path + ")", res.emittedBytes, *limit);
+        }
+
+        if (budget.contains("headers"))
+        {
+            std::vector<HeaderTotal> headers = headerTotals();
+            for (const auto& [key, value] : budget["headers"].items())
+            {
+                auto limit = limitOf(value, "header \"" + key + "\"");
+                if (!limit)
+                    continue;
+
+                for (const auto& header : headers)
+                {
+                    if (header.header == key || fs::path(header.header).filename() == key)
+                        exceeds(headerLabel(header.header), header.emittedBytes, *limit);
+                }
+            }
+        }
+
+        if (ok)
+            mLog.info() << "Size budget " << budgetPath << ": " << formatBytes(totalBytes) << " emitted, within limits";
+        return ok;
+    }
+
+} // namespace resman
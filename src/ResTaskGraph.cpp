@@ -0,0 +1,168 @@
+#include "ResTaskGraph.h"
+
+#include <thread>
+#include <algorithm>
+#include <exception>
+
+namespace resman
+{
+    ResTaskGraph::ResTaskGraph(unsigned threadCount)
+        : mThreadCount(threadCount ? threadCount : std::max(1u, std::thread::hardware_concurrency()))
+    {
+    }
+
+    ResTaskGraph& ResTaskGraph::setLogCallback(LogCallback callback)
+    {
+        mLog.setCallback(std::move(callback));
+        return *this;
+    }
+
+    ResTaskGraph::TaskId ResTaskGraph::addTask(std::function<bool()> fn, const std::vector<TaskId>& dependencies)
+    {
+        TaskId id = mTasks.size();
+        auto task = std::make_unique<Task>();
+        task->fn = std::move(fn);
+        task->pending = dependencies.size();
+        mTasks.push_back(std::move(task));
+
+        for (TaskId dep : dependencies)
+            mTasks[dep]->dependents.push_back(id);
+
+        return id;
+    }
+
+    //──────────────────────────────
+    // Scheduling
+    //──────────────────────────────
+    void ResTaskGraph::pushTask(unsigned index, TaskId task)
+    {
+        {
+            // counted under the queue lock, so a take never sees the task uncounted
+            std::lock_guard<std::mutex> lock(mWorkers[index]->mutex);
+            mWorkers[index]->queue.push_back(task);
+            ++mQueued;
+        }
+
+        {
+            // a worker about to sleep either sees the count or is waiting already
+            std::lock_guard<std::mutex> lock(mIdleMutex);
+        }
+        mIdleCond.notify_one();
+    }
+
+    // Own queue newest first, then the oldest task of another worker
+    bool ResTaskGraph::takeTask(unsigned index, TaskId& task)
+    {
+        {
+            Worker& own = *mWorkers[index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.queue.empty())
+            {
+                task = own.queue.back();
+                own.queue.pop_back();
+                --mQueued;
+                return true;
+            }
+        }
+
+        for (size_t i = 1; i < mWorkers.size(); ++i)
+        {
+            Worker& victim = *mWorkers[(index + i) % mWorkers.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.queue.empty())
+            {
+                task = victim.queue.front();
+                victim.queue.pop_front();
+                --mQueued;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void ResTaskGraph::finishTask(unsigned index, TaskId task)
+    {
+        for (TaskId dependent : mTasks[task]->dependents)
+        {
+            if (--mTasks[dependent]->pending == 0)
+                pushTask(index, dependent);
+        }
+
+        if (--mRemaining == 0)
+        {
+            std::lock_guard<std::mutex> lock(mIdleMutex);
+            mIdleCond.notify_all();
+        }
+    }
+
+    void ResTaskGraph::workerLoop(unsigned index)
+    {
+        while (true)
+        {
+            TaskId task;
+            if (takeTask(index, task))
+            {
+                // after a failure, the remaining tasks only resolve their dependents
+                if (!mFailed)
+                {
+                    bool ok = false;
+                    try
+                    {
+                        ok = mTasks[task]->fn();
+                    }
+                    catch (const std::exception& e)
+                    {
+                        mLog.error() << "Error: " << e.what();
+                    }
+                    catch (...)
+                    {
+                        mLog.error() << "Error: unknown exception in a build task";
+                    }
+
+                    if (!ok)
+                        mFailed = true;
+                }
+
+                finishTask(index, task);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(mIdleMutex);
+            mIdleCond.wait(lock, [this] { return mQueued > 0 || mRemaining == 0; });
+            if (mRemaining == 0)
+                return;
+        }
+    }
+
+    bool ResTaskGraph::run()
+    {
+        if (mTasks.empty())
+            return true;
+
+        unsigned threadCount = static_cast<unsigned>(std::min<size_t>(mThreadCount, mTasks.size()));
+        for (unsigned i = 0; i < threadCount; ++i)
+            mWorkers.push_back(std::make_unique<Worker>());
+
+        mRemaining = mTasks.size();
+
+        // initial tasks round-robin, in reverse so each worker starts with the earliest ones
+        std::vector<TaskId> ready;
+        for (TaskId id = 0; id < mTasks.size(); ++id)
+            if (mTasks[id]->pending == 0)
+                ready.push_back(id);
+
+        for (size_t i = ready.size(); i-- > 0;)
+            pushTask(static_cast<unsigned>(i % threadCount), ready[i]);
+
+        std::vector<std::thread> threads;
+        for (unsigned i = 1; i < threadCount; ++i)
+            threads.emplace_back(&ResTaskGraph::workerLoop, this, i);
+        workerLoop(0);
+        for (auto& thread : threads)
+            thread.join();
+
+        return !mFailed;
+    }
+
+} // namespace resman
@@ -0,0 +1,89 @@
+#include "ResToolVersion.h"
+
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <random>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <algorithm>
+#include <cctype>
+
+namespace fs = std::filesystem;
+
+namespace resman
+{
+    // The tool name, version and default target lines; the rest (host CPU,
+    // install dir, registered targets) differs between machines running the
+    // same build, which would keep them from sharing cache entries
+    static std::string normalizeVersionText(const std::string& text)
+    {
+        std::istringstream in(text);
+        std::string normalized;
+        std::string line;
+        bool first = true;
+        while (std::getline(in, line))
+        {
+            size_t begin = line.find_first_not_of(" \t\r");
+            if (begin == std::string::npos)
+                continue;
+            line = line.substr(begin, line.find_last_not_of(" \t\r") + 1 - begin);
+
+            std::string lower = line;
+            std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+            bool keep = first || lower.find("version") != std::string::npos ||
+                        lower.compare(0, 7, "target:") == 0 || lower.compare(0, 15, "default target:") == 0;
+            first = false;
+
+            if (keep)
+                normalized += line + "\n";
+        }
+        return normalized;
+    }
+
+    std::string queryToolVersion(const std::string& toolPath, const std::string& scratchDir)
+    {
+        // builds driven from one long-lived process only spawn each tool once
+        static std::mutex versionMutex;
+        static std::map<std::string, std::string> knownVersions;
+
+        std::lock_guard<std::mutex> lock(versionMutex);
+        if (auto it = knownVersions.find(toolPath); it != knownVersions.end())
+            return it->second;
+
+        fs::path dir = scratchDir.empty() ? fs::temp_directory_path() : fs::path(scratchDir);
+        fs::path versionFile = dir / ("tool_version" + std::to_string(std::random_device{}()) + ".txt");
+
+        std::ostringstream cmd;
+        if (toolPath.find(' ') != std::string::npos)
+            cmd << "\"" << toolPath << "\"";
+        else
+            cmd << toolPath;
+
+        if (versionFile.string().find(' ') != std::string::npos)
+            cmd << " --version > \"" << versionFile.string() << "\" 2>&1";
+        else
+            cmd << " --version > " << versionFile.string() << " 2>&1";
+
+        int rc = std::system(cmd.str().c_str());
+
+        std::string version;
+        {
+            std::ifstream in(versionFile);
+            version.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+
+        std::error_code ec;
+        fs::remove(versionFile, ec);
+
+        if (rc != 0)
+            return "";
+
+        version = normalizeVersionText(version);
+
+        if (!version.empty())
+            knownVersions[toolPath] = version;
+        return version;
+    }
+}
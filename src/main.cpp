@@ -1,17 +1,75 @@
 #include <iostream>
 #include <filesystem>
+#include <sstream>
 #include <argparse/argparse.hpp>
 #include "ResBuildOrchestrator.h"
+#include "ResDelta.h"
+#include "ResJobServer.h"
+
+// resman-lite delta / resman-lite apply: binary deltas between build outputs
+static int runDeltaCommand(int argc, char** argv)
+{
+    const std::string command = argv[0];
+    const bool apply = command == "apply";
+    argparse::ArgumentParser program("resman-lite " + command, "0.1");
+
+    if (apply)
+    {
+        program.add_description("Rebuilds a new build output from the previous one and a delta.");
+        program.add_argument("--delta").help("Delta written by resman-lite delta").required();
+        program.add_argument("-o", "--output").help("Output file (replaced only once the result is verified)").required();
+    }
+    else
+    {
+        program.add_description("Writes a binary delta that turns one build output into another.");
+        program.add_argument("--new").help("New object, bitcode or archive").required();
+        program.add_argument("-o", "--output").help("Delta file to write").required();
+    }
+    program.add_argument("--old").help("Previous object, bitcode or archive").required();
+
+    try
+    {
+        program.parse_args(argc, argv);
+    }
+    catch (const std::exception& err)
+    {
+        std::cerr << "Error: " << err.what() << "\n\n";
+        std::cerr << program;
+        return 1;
+    }
+
+    bool success = apply
+        ? resman::ResDeltaApplier()
+              .setOldFile(program.get<std::string>("--old"))
+              .setDeltaFile(program.get<std::string>("--delta"))
+              .setOutputFile(program.get<std::string>("--output"))
+              .run()
+        : resman::ResDeltaGenerator()
+              .setOldFile(program.get<std::string>("--old"))
+              .setNewFile(program.get<std::string>("--new"))
+              .setDeltaFile(program.get<std::string>("--output"))
+              .run();
+
+    return success ? 0 : 1;
+}
 
 int main(int argc, char** argv)
 {
+    // before any file is opened: claims make's jobserver descriptors
+    resman::ResJobServer::instance();
+
+    if (argc > 1 && (std::string(argv[1]) == "delta" || std::string(argv[1]) == "apply"))
+        return runDeltaCommand(argc - 1, argv + 1);
+
     argparse::ArgumentParser program("resman-lite", "0.1");
 
     program.add_description("Cross-platform resource-to-object generator using LLVM + Clang cli tools.");
 
     program.add_argument("-r", "--res-header")
-        .help("Resource header file (Header file path containing resman::Resource<> declarations)")
-        .required();
+        .help("Resource header file (Header file path containing resman::Resource<> declarations). "
+              "Repeatable; headers are parsed concurrently and their resources merged")
+        .required()
+        .append();
 
     program.add_argument("-o", "--obj-name")
         .help("Output object file name (e.g., resources.o or resources.obj)")
@@ -26,13 +84,121 @@ int main(int argc, char** argv)
         .append();
 
     program.add_argument("-t", "--mtriple")
-        .help("Target triple (e.g., x86_64-pc-windows-msvc, x86_64-unknown-linux-gnu, aarch64-pc-windows-msvc etc. By default, the host triple is used)")
-        .default_value(std::string(""));
+        .help("Target triple (e.g., x86_64-pc-windows-msvc, x86_64-unknown-linux-gnu, aarch64-pc-windows-msvc etc. By default, the host triple is used). "
+              "Repeatable or comma-separated; with several triples one object per triple is written to <obj-stem>.<triple><obj-ext>")
+        .append();
 
     program.add_argument("-w", "--working-dir")
         .help("Working directory (optional; if not provided, a temporary one is used)")
         .default_value(std::string(""));
 
+    program.add_argument("--cache-dir")
+        .help("Directory for cached header parse results (optional; defaults to $RESMAN_LITE_CACHE_DIR, then a temp directory)")
+        .default_value(std::string(""));
+
+    program.add_argument("--no-cache")
+        .help("Always re-parse the resource header with clang")
+        .default_value(false)
+        .implicit_value(true);
+
+    program.add_argument("--object-cache")
+        .help("Reuse compiled bitcode and objects across builds and projects, from <cache-dir>/objects "
+              "(also enabled by RESMAN_LITE_OBJECT_CACHE=1)")
+        .default_value(false)
+        .implicit_value(true);
+
+    program.add_argument("--object-cache-max-size")
+        .help("Size limit of the object cache in MiB; least recently used entries are evicted beyond it")
+        .default_value(2048u)
+        .scan<'u', unsigned>();
+
+    program.add_argument("--depfile")
+        .help("Write a make/ninja dependency file listing the header, its includes and every embedded resource")
+        .default_value(std::string(""));
+
+    program.add_argument("--write-if-changed")
+        .help("Leave the output object untouched (keeping its mtime) when its contents would not change")
+        .default_value(false)
+        .implicit_value(true);
+
+    program.add_argument("--shard")
+        .help("Build only shard <index>/<count> of the declared resources (e.g. 2/8), for parallel builds of one header")
+        .default_value(std::string(""));
+
+    program.add_argument("--resource-registry")
+        .help("Register every embedded resource with the runtime, for resman::forEachResource / resman::prefetchAll")
+        .default_value(false)
+        .implicit_value(true);
+
+    program.add_argument("-j", "--jobs")
+        .help("Number of threads reading, encoding and compiling resources (0 = one per CPU core)")
+        .default_value(0u)
+        .scan<'u', unsigned>();
+
+    program.add_argument("--dev-mode")
+        .help("Reference each resource by its absolute path instead of embedding it; the RESMAN_DEV_MODE "
+              "runtime maps the file and reloads it when it changes (edit-run loops, never for release)")
+        .default_value(false)
+        .implicit_value(true);
+
+    program.add_argument("--dedup-content")
+        .help("Store each resource under a symbol keyed by its content hash, in a COMDAT group, so data "
+              "embedded by several libraries is linked once; consumers must define RESMAN_DEDUP_CONTENT")
+        .default_value(false)
+        .implicit_value(true);
+
+    program.add_argument("--blob-layout")
+        .help("Place all resources in one blob symbol, indexed by offsets relative to it: no per-resource "
+              "symbols or relocations; consumers must define RESMAN_BLOB_LAYOUT")
+        .default_value(false)
+        .implicit_value(true);
+
+    program.add_argument("--chunk-dedup")
+        .help("With the blob layout (implied): split resources into content-defined chunks and store each "
+              "distinct chunk once, for families of near-identical files")
+        .default_value(false)
+        .implicit_value(true);
+
+    program.add_argument("--blob-symbol")
+        .help("extern \"C\" name of the blob layout's index, the one symbol of the object; unique per "
+              "program, and the name to force-link (-u) from a static library (default: "
+              "resman_lite_blob_<object file stem>)");
+
+    program.add_argument("--layout-profile")
+        .help("Access profile written by a program built with -DRESMAN_PROFILE (repeatable); "
+              "resources are laid out in first-access order, unused ones last")
+        .append();
+
+    program.add_argument("--verify-reproducible")
+        .help("Build a second time from scratch (another temp dir, no object cache) and fail unless "
+              "the outputs are identical byte for byte")
+        .default_value(false)
+        .implicit_value(true);
+
+    program.add_argument("--size-report")
+        .help("Write the bytes each resource and header contributes (raw, generated source, emitted), "
+              "largest first, as JSON to this file and as text next to it (.txt)")
+        .default_value(std::string(""));
+
+    program.add_argument("--size-baseline")
+        .help("With --size-report: size report of an earlier build, to list what grew or shrank since")
+        .default_value(std::string(""));
+
+    program.add_argument("--size-budget")
+        .help("JSON file with size limits for the total, any resource, named resources or headers; "
+              "the build fails when one is exceeded")
+        .default_value(std::string(""));
+
+    program.add_argument("--emit-bc")
+        .help("Write LLVM bitcode (after llvm-link) instead of an object, for LTO builds")
+        .default_value(false)
+        .implicit_value(true);
+
+    program.add_argument("--thin-lto")
+        .help("With --emit-bc: write an archive of per-resource ThinLTO bitcode modules instead of one merged module")
+        .default_value(false)
+        .implicit_value(true);
+
     program.add_argument("--clang-path")
         .help("Path to clang++ binary (optional, defaults to clang++ in PATH)")
         .default_value(std::string("clang++"));
@@ -49,6 +215,10 @@ int main(int argc, char** argv)
         .help("Path to llc binary (optional, defaults to llc in PATH)")
         .default_value(std::string("llc"));
 
+    program.add_argument("--llvm-ar-path")
+        .help("Path to llvm-ar binary (optional, defaults to llvm-ar in PATH; used by --emit-bc --thin-lto)")
+        .default_value(std::string("llvm-ar"));
+
     try
     {
         program.parse_args(argc, argv);
@@ -60,7 +230,9 @@ int main(int argc, char** argv)
         }
 
         resman::BuildOptions opts;
-        opts.resHeader = program.get<std::string>("--res-header");
+        auto headers = program.get<std::vector<std::string>>("--res-header");
+        opts.resHeader = headers.front();
+        opts.resHeaders.assign(headers.begin() + 1, headers.end());
         opts.outputObj = program.get<std::string>("--obj-name");
 
         if (program.is_used("--include-path"))
@@ -69,14 +241,84 @@ int main(int argc, char** argv)
         if (program.is_used("--res-path"))
             opts.resPaths = program.get<std::vector<std::string>>("--res-path");
 
-        opts.targetTriple = program.get<std::string>("--mtriple");
+        if (program.is_used("--mtriple"))
+        {
+            for (const auto& arg : program.get<std::vector<std::string>>("--mtriple"))
+            {
+                std::stringstream ss(arg);
+                std::string triple;
+                while (std::getline(ss, triple, ','))
+                    if (!triple.empty())
+                        opts.targetTriples.push_back(triple);
+            }
+        }
 
         std::string workingDir = program.get<std::string>("--working-dir");
         if (!workingDir.empty())
             opts.workingDir = workingDir;
 
+        std::string cacheDir = program.get<std::string>("--cache-dir");
+        if (!cacheDir.empty())
+            opts.cacheDir = cacheDir;
+        opts.useCache = !program.get<bool>("--no-cache");
+        opts.useObjectCache = program.get<bool>("--object-cache");
+        opts.objectCacheMaxBytes = std::uint64_t(program.get<unsigned>("--object-cache-max-size")) << 20;
+
+        std::string depFile = program.get<std::string>("--depfile");
+        if (!depFile.empty())
+            opts.depFile = depFile;
+        opts.writeIfChanged = program.get<bool>("--write-if-changed");
+
+        std::string shard = program.get<std::string>("--shard");
+        if (!shard.empty())
+        {
+            auto slash = shard.find('/');
+            if (slash == std::string::npos)
+                throw std::runtime_error("--shard expects <index>/<count>, got: " + shard);
+
+            opts.shardIndex = static_cast<unsigned>(std::stoul(shard.substr(0, slash)));
+            opts.shardCount = static_cast<unsigned>(std::stoul(shard.substr(slash + 1)));
+        }
+
+        opts.emitRegistry = program.get<bool>("--resource-registry");
+        opts.jobs = program.get<unsigned>("--jobs");
+        opts.devMode = program.get<bool>("--dev-mode");
+        opts.dedupContent = program.get<bool>("--dedup-content");
+        opts.blobLayout = program.get<bool>("--blob-layout");
+        opts.chunkDedup = program.get<bool>("--chunk-dedup");
+        if (program.is_used("--blob-symbol"))
+            opts.blobSymbol = program.get<std::string>("--blob-symbol");
+        if (program.is_used("--layout-profile"))
+            opts.layoutProfiles = program.get<std::vector<std::string>>("--layout-profile");
+        opts.verifyReproducible = program.get<bool>("--verify-reproducible");
+        std::string sizeReport = program.get<std::string>("--size-report");
+        if (!sizeReport.empty())
+            opts.sizeReport = sizeReport;
+        std::string sizeBaseline = program.get<std::string>("--size-baseline");
+        if (!sizeBaseline.empty())
+        {
+            if (sizeReport.empty())
+                throw std::runtime_error("--size-baseline requires --size-report");
+            opts.sizeBaseline = sizeBaseline;
+        }
+        std::string sizeBudget = program.get<std::string>("--size-budget");
+        if (!sizeBudget.empty())
+            opts.sizeBudget = sizeBudget;
+        opts.emitBitcode = program.get<bool>("--emit-bc");
+        opts.thinLto = program.get<bool>("--thin-lto");
+        if (opts.thinLto && !opts.emitBitcode)
+            throw std::runtime_error("--thin-lto requires --emit-bc");
+
+        // LLVM tool paths
+        opts.clangPath    = program.get<std::string>("--clang-path");
+        opts.llvmAsPath   = program.get<std::string>("--llvm-as-path");
+        opts.llvmLinkPath = program.get<std::string>("--llvm-link-path");
+        opts.llcPath      = program.get<std::string>("--llc-path");
+        opts.llvmArPath   = program.get<std::string>("--llvm-ar-path");
+
         std::cout << "\nresman-lite configuration:\n";
         std::cout << "  Header        : " << opts.resHeader << "\n";
+        for (auto& h : opts.resHeaders) std::cout << "                  " << h << "\n";
         std::cout << "  Output Object : " << opts.outputObj << "\n";
         if (!opts.includePaths.empty())
         {
@@ -88,29 +330,15 @@ int main(int argc, char** argv)
             std::cout << "  Resource Dirs :\n";
             for (auto& p : opts.resPaths) std::cout << "    - " << p << "\n";
         }
-        if (!opts.targetTriple.empty())
-            std::cout << "  Target Triple : " << opts.targetTriple << "\n";
+        if (!opts.targetTriples.empty())
+        {
+            std::cout << "  Target Triples:\n";
+            for (auto& t : opts.targetTriples) std::cout << "    - " << t << "\n";
+        }
         if (opts.workingDir.has_value())
             std::cout << "  Working Dir   : " << *opts.workingDir << "\n";
         std::cout << std::endl;
 
-         // LLVM tool path arguments
-        program.add_argument("--clang-path")
-            .help("Path to clang++ binary (optional; defaults to clang++ in PATH)")
-            .default_value(std::string("clang++"));
-
-        program.add_argument("--llvm-as-path")
-            .help("Path to llvm-as binary (optional; defaults to llvm-as in PATH)")
-            .default_value(std::string("llvm-as"));
-
-        program.add_argument("--llvm-link-path")
-            .help("Path to llvm-link binary (optional; defaults to llvm-link in PATH)")
-            .default_value(std::string("llvm-link"));
-
-        program.add_argument("--llc-path")
-            .help("Path to llc binary (optional; defaults to llc in PATH)")
-            .default_value(std::string("llc"));
-
         resman::ResBuildOrchestrator orch;
         bool success = orch.setOptions(opts).run();
 